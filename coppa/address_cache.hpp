@@ -0,0 +1,109 @@
+#pragma once
+#include <coppa/string_view.hpp>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace coppa
+{
+// 64-bit hash of an address, eight bytes at a time.
+inline uint64_t hash_address(string_view address)
+{
+  uint64_t h = 0xcbf29ce484222325ULL ^ address.size();
+  const char* data = address.data();
+  std::size_t n = address.size();
+
+  const auto mix = [&] (uint64_t word) {
+    h ^= word;
+    h *= 0x100000001b3ULL;
+    h ^= h >> 29;
+  };
+
+  for(; n >= 8; n -= 8, data += 8)
+  {
+    uint64_t word;
+    std::memcpy(&word, data, 8);
+    mix(word);
+  }
+
+  if(n > 0)
+  {
+    uint64_t word = 0;
+    std::memcpy(&word, data, n);
+    mix(word);
+  }
+
+  return h;
+}
+
+/**
+ * @brief The address_cache class
+ *
+ * Direct-mapped cache from addresses to map iterators :
+ * a lookup is a hash, one probe and one memcmp with the destination
+ * of the cached node to confirm the match, instead of a search with
+ * string comparisons in the ordered index.
+ *
+ * clear() must be called whenever iterators may be invalidated.
+ * It is not thread-safe : it is meant to be owned by a map and
+ * used with the map's write lock held.
+ * Copies are empty, since the iterators refer to the original map.
+ */
+template<typename Iterator, std::size_t Size = 256>
+class address_cache
+{
+    static_assert((Size & (Size - 1)) == 0, "Size must be a power of two");
+
+  public:
+    address_cache() = default;
+    address_cache(const address_cache&) { }
+    address_cache(address_cache&&) { }
+    address_cache& operator=(const address_cache&) { clear(); return *this; }
+    address_cache& operator=(address_cache&&) { clear(); return *this; }
+
+    // Looks up the address in the cache, then in the map.
+    // Only found addresses are cached.
+    template<typename Map>
+    Iterator find(const Map& map, string_view address)
+    {
+      const auto h = hash_address(address);
+      auto& e = m_entries[h & (Size - 1)];
+      if(e.generation == m_generation && e.hash == h)
+      {
+        const std::string& dest = e.it->destination;
+        if(dest.size() == address.size()
+           && std::memcmp(dest.data(), address.data(), address.size()) == 0)
+          return e.it;
+      }
+
+      auto it = map.find(address);
+      if(it != map.end())
+      {
+        e.hash = h;
+        e.generation = m_generation;
+        e.it = it;
+      }
+      return it;
+    }
+
+    void clear()
+    {
+      m_generation++;
+    }
+
+  private:
+    struct entry
+    {
+        uint64_t hash{};
+        uint64_t generation{};
+        Iterator it{};
+    };
+
+    std::array<entry, Size> m_entries;
+
+    // Entries from an older generation are invalid.
+    uint64_t m_generation = 1;
+};
+
+}
@@ -102,6 +102,22 @@ class local_device
       m_handlers.erase(name);
     }
 
+    bool has_handler(const std::string& name) const
+    {
+      return m_handlers.find(name) != std::end(m_handlers);
+    }
+
+    // Calls the handler of the address of the parameter, if any,
+    // e.g. after it was modified in place.
+    void notify(const typename Map::value_type& parameter)
+    {
+      auto it = m_handlers.find(parameter.destination);
+      if(it != std::end(m_handlers))
+      {
+        (it->second)(parameter);
+      }
+    }
+
     template<typename Arg>
     void update(const std::string& path, Arg&& val)
     {
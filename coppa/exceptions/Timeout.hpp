@@ -0,0 +1,12 @@
+#pragma once
+#include <stdexcept>
+#include <string>
+class TimeoutException: public std::runtime_error
+{
+  public:
+    TimeoutException():
+      std::runtime_error{"Request timed out"} { }
+
+    TimeoutException(const std::string& message):
+      std::runtime_error{"Request timed out : " + message} { }
+};
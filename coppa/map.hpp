@@ -11,6 +11,8 @@
 #include <boost/algorithm/string.hpp>
 #include <boost/optional.hpp>
 #include <coppa/string_view.hpp>
+#include <coppa/address_cache.hpp>
+#include <coppa/namespace_reply_cache.hpp>
 #include <type_traits>
 namespace coppa
 {
@@ -81,6 +83,23 @@ std::vector<string_view> get_children_names(
 }
 
 
+// The map should be locked beforehand and be ordered
+template<typename Map>
+bool has_children(
+    const Map& map,
+    string_view addr)
+{
+  std::string prefix{addr.data(), addr.size()};
+  if(prefix.empty() || prefix.back() != '/')
+    prefix.push_back('/');
+
+  // The children follow "addr/" in the order of the index.
+  const auto& index = map.map_impl().template get<0>();
+  auto it = index.upper_bound(prefix);
+  return it != index.end() && boost::starts_with(it->destination, prefix);
+}
+
+
 inline bool isRoot(string_view address)
 {
   return address.size() == 1;
@@ -132,6 +151,7 @@ class basic_map
     using base_map_type = Map;
     using size_type = typename Map::size_type;
     using value_type = typename base_map_type::value_type;
+    using iterator = typename Map::template nth_index<0>::type::const_iterator;
 
     constexpr basic_map()
     { insert(make_root_node()); }
@@ -139,6 +159,8 @@ class basic_map
     basic_map& operator=(Map&& map)
     {
       m_map = std::move(map);
+      m_cache.clear();
+      m_replies.clear();
       return *this;
     }
 
@@ -186,9 +208,26 @@ class basic_map
     FORWARD_FUN_CONST(m_map, auto, begin)
     FORWARD_FUN_CONST(m_map, auto, end)
 
+    // Like find, but the addresses found recently are cached :
+    // steady traffic on the same addresses does not search the index.
+    // Not thread-safe, even on a const map : with a locked_map,
+    // the write lock has to be held.
+    auto find_cached(string_view address) const
+    {
+      return m_cache.find(*this, address);
+    }
+
     // TODO add insert_and_assign
     // See boost doc with rollback, too.
-    FORWARD_FUN(m_map, auto, insert)
+    template<typename... Args>
+    auto insert(Args&&... args)
+    {
+      m_cache.clear();
+      auto res = m_map.insert(std::forward<Args>(args)...);
+      if(res.second)
+        m_replies.invalidate(res.first->destination);
+      return res;
+    }
 
     template<typename Key,
              typename Updater>
@@ -202,6 +241,7 @@ class basic_map
         bool res = param_index.modify(it, std::forward<Updater>(updater));
         if(res)
             return it;
+        erased();
         return end;
       }
       return end;
@@ -219,11 +259,22 @@ class basic_map
         bool res = param_index.modify(it, std::forward<Updater>(updater));
         if(res)
             return it;
+        erased();
         return end;
       }
       return end;
     }
 
+    // Modifies the node without checking its position in the indices
+    // afterwards, unlike update_it : the updater must not change
+    // the destination.
+    template<typename Iterator,
+             typename Updater>
+    void update_in_place(Iterator it, Updater&& updater)
+    {
+      std::forward<Updater>(updater)(const_cast<value_type&>(*it));
+    }
+
     template<typename Key,
              typename... Args>
     auto update_attributes(Key&& address, Args&&... args)
@@ -257,9 +308,12 @@ class basic_map
     template<typename Key>
     auto remove(Key&& k)
     {
+      m_cache.clear();
+
       // Remove the path and its children
       for(auto&& elt : filter(*this, std::forward<Key>(k)))
       {
+        m_replies.invalidate(elt.destination);
         m_map.template get<0>().erase(elt.destination);
       }
 
@@ -286,6 +340,8 @@ class basic_map
     void clear()
     {
       m_map.clear();
+      m_cache.clear();
+      m_replies.clear();
     }
 
     bool acquire_read_lock() const
@@ -296,6 +352,25 @@ class basic_map
 
     auto& get_data_map()
     { return *this; }
+
+    // The encoded replies to the namespace requests.
+    // Only the insertions and removals of nodes invalidate them :
+    // the updates must not change the destination of the nodes.
+    // Thread-safe : see namespace_reply_cache.
+    namespace_reply_cache& namespace_replies() const
+    { return m_replies; }
+
+  private:
+    // modify erases the node when its new address is already taken :
+    // the cached iterators and namespace replies may refer to it.
+    void erased()
+    {
+      m_cache.clear();
+      m_replies.clear();
+    }
+
+    mutable address_cache<iterator> m_cache;
+    mutable namespace_reply_cache m_replies;
 };
 
 
@@ -315,6 +390,7 @@ class locked_map
     using parent_map_type = Map;
     using base_map_type = typename Map::base_map_type;
     using value_type = typename base_map_type::value_type;
+    using iterator = typename Map::iterator;
 
     constexpr locked_map(Map& source):
       m_map{source}
@@ -366,6 +442,10 @@ class locked_map
       return const_cast<const Map&>(m_map).find(std::forward<K>(k));
     }
 
+    // Unsafe : requires the write lock, see basic_map::find_cached.
+    auto find_cached(string_view address) const
+    { return m_map.find_cached(address); }
+
     // operator[] to be locked explicitly from the outside since
     // it returns a ref.
     auto& operator[](typename Map::size_type i)
@@ -2,6 +2,7 @@
 #include <oscpack/osc/OscReceivedElements.h>
 #include <coppa/minuit/parameter.hpp>
 #include <oscpack/osc/OscTypesTraits.h>
+#include <coppa/protocol/osc/oscbulk.hpp>
 #include <coppa/exceptions/BadRequest.hpp>
 
 namespace coppa
@@ -66,6 +67,25 @@ std::string convert_string(oscpack::ReceivedMessageArgument arg)
   }
 }
 
+// Same, but reuses the capacity of the current string.
+template<typename ErrorHandler>
+void convert_string(oscpack::ReceivedMessageArgument arg, std::string& val)
+{
+  using namespace oscpack;
+  switch(arg.TypeTag())
+  {
+    case STRING_TYPE_TAG:
+      val.assign(arg.AsStringUnchecked());
+      break;
+    case SYMBOL_TYPE_TAG:
+      val.assign(arg.AsSymbolUnchecked());
+      break;
+    default:
+      val = ErrorHandler{}(std::string{});
+      break;
+  }
+}
+
 
 
 inline oscpack::ReceivedMessageArgumentIterator skip_array(
@@ -96,31 +116,90 @@ inline oscpack::ReceivedMessageArgumentIterator skip_array(
 
 }
 
+// Default value of the type of an OSC argument.
+inline Variant default_value(char tag)
+{
+  using namespace oscpack;
+  switch(tag)
+  {
+    case TRUE_TYPE_TAG:
+    case FALSE_TYPE_TAG:
+      return bool{};
+    case INT32_TYPE_TAG:
+    case INT64_TYPE_TAG:
+      return int32_t{};
+    case FLOAT_TYPE_TAG:
+    case DOUBLE_TYPE_TAG:
+      return float{};
+    case CHAR_TYPE_TAG:
+      return char{};
+    case STRING_TYPE_TAG:
+    case SYMBOL_TYPE_TAG:
+      return std::string{};
+    case BLOB_TYPE_TAG:
+      return Generic{};
+    case ARRAY_BEGIN_TYPE_TAG:
+      return Tuple{};
+    case INFINITUM_TYPE_TAG:
+      return Impulse{};
+    default:
+      return None{};
+  }
+}
+
+// If the message is given, the long runs of int32 or float
+// in the array are decoded in bulk.
 template<typename Fun>
 oscpack::ReceivedMessageArgumentIterator read_array(
     Fun& f,
     oscpack::ReceivedMessageArgumentIterator it,
-    Tuple& tuple)
+    Tuple& tuple,
+    const oscpack::ReceivedMessage* m = nullptr)
 {
   using eggs::variants::get;
   // First is the '['
-  char c = (++it)->TypeTag();
+  ++it;
+
+  osc::argument_position pos;
+  if(m)
+    pos = osc::locate(*m, it);
+
+  char c = it->TypeTag();
   auto i = 0U;
   while(c != oscpack::ARRAY_END_TYPE_TAG)
   {
-    if(tuple.variants.size() >= i)
+    const auto run = pos.tag ? osc::numeric_run(pos.tag) : 0;
+    if(run >= osc::bulk_threshold)
     {
-      it = f(it, tuple.variants[i]);
+      osc::read_numeric_run(pos, run, tuple.variants, i);
+      pos.tag += run;
+      pos.data += 4 * run;
+      for(std::size_t k = 0; k < run; k++)
+        ++it;
+      i += run;
     }
     else
     {
-      // TODO in some cases this should maybe be an error ?
-      tuple.variants.resize(tuple.variants.size() + 1);
-      it = f(it, tuple.variants.back());
+      if(i >= tuple.variants.size())
+      {
+        // TODO in some cases this should maybe be an error ?
+        // The new elements take the type of the received ones.
+        tuple.variants.push_back(default_value(c));
+      }
+
+      // f reads a single argument, except for arrays :
+      // then the position is lost for the rest of this array.
+      auto& elt = tuple.variants[i];
+      if(c == oscpack::ARRAY_BEGIN_TYPE_TAG || which(elt) == Type::tuple_t)
+        pos = {};
+      else if(pos.tag)
+        pos.advance();
+
+      it = f(it, elt);
+      i++;
     }
 
     c = it->TypeTag();
-    i++;
   }
 
   // At this point it is on ']'
@@ -133,7 +212,8 @@ template<typename ErrorHandler,
 oscpack::ReceivedMessageArgumentIterator convert_tuple(
     Fun& fun,
     oscpack::ReceivedMessageArgumentIterator it,
-    Tuple& tuple)
+    Tuple& tuple,
+    const oscpack::ReceivedMessage* m = nullptr)
 {
   using namespace oscpack;
 
@@ -146,7 +226,7 @@ oscpack::ReceivedMessageArgumentIterator convert_tuple(
   if(type == ARRAY_BEGIN_TYPE_TAG)
   {
     // Handle tuple case
-    return read_array(fun, it, tuple);
+    return read_array(fun, it, tuple, m);
   }
   else
   {
@@ -205,6 +285,9 @@ struct value_maker;
 template<typename ErrorHandler>
 struct value_maker<ErrorHandler, conversion_mode::Convert>
 {
+    // If set, the numeric arrays are decoded in bulk.
+    const oscpack::ReceivedMessage* message{};
+
     auto operator()(
         oscpack::ReceivedMessageArgumentIterator arg,
         Variant& elt)
@@ -241,13 +324,13 @@ struct value_maker<ErrorHandler, conversion_mode::Convert>
             ++it;
           }
           void operator()(std::string& val) const {
-            val = convert_string<ErrorHandler>(*it);
+            convert_string<ErrorHandler>(*it, val);
             ++it;
           }
           void operator()(Tuple& t) const {
             if(it->IsArrayBegin())
             {
-              it = convert_tuple<ErrorHandler>(parent, it, t);
+              it = convert_tuple<ErrorHandler>(parent, it, t, parent.message);
             }
             else
             {
@@ -258,7 +341,7 @@ struct value_maker<ErrorHandler, conversion_mode::Convert>
             int n = 0;
             const char* data{};
             it->AsBlob(reinterpret_cast<const void*&>(data), n);
-            val = coppa::Generic{std::string(data, n)};
+            val.buf.assign(data, n);
             ++it;
           }
 
@@ -273,6 +356,9 @@ struct value_maker<ErrorHandler, conversion_mode::Convert>
 template<typename ErrorHandler>
 struct value_maker<ErrorHandler, conversion_mode::Prechecked>
 {
+    // If set, the numeric arrays are decoded in bulk.
+    const oscpack::ReceivedMessage* message{};
+
     auto operator()(
         oscpack::ReceivedMessageArgumentIterator arg,
         Variant& elt)
@@ -313,21 +399,19 @@ struct value_maker<ErrorHandler, conversion_mode::Prechecked>
           }
 
           return_type operator()(std::string& val) const {
-            val = it->AsStringUnchecked();
+            val.assign(it->AsStringUnchecked());
             ++it;
           }
 
           return_type operator()(Tuple& t) const {
-            it = read_array(parent, it, t);
-            // this one can be optimized since we know for sure that
-            // the size is always correct
+            it = read_array(parent, it, t, parent.message);
           }
 
           return_type operator()(Generic& val) const {
             int n = 0;
             const char* data{};
             it->AsBlobUnchecked(reinterpret_cast<const void*&>(data), n);
-            val = coppa::Generic{std::string(data, n)};
+            val.buf.assign(data, n);
             ++it;
           }
 
@@ -387,7 +471,7 @@ struct value_maker<ErrorHandler, conversion_mode::Ignore>
 
           return_type operator()(std::string& val) const {
             if(it->IsString())
-              val = it->AsStringUnchecked();
+              val.assign(it->AsStringUnchecked());
             ++it;
           }
 
@@ -409,7 +493,7 @@ struct value_maker<ErrorHandler, conversion_mode::Ignore>
               int32_t n = 0;
               const char* data{};
               it->AsBlobUnchecked(reinterpret_cast<const void*&>(data), n);
-              val.buf = std::string{data, std::size_t(n)};
+              val.buf.assign(data, std::size_t(n));
             }
             ++it;
           }
@@ -461,14 +545,21 @@ struct value_maker<ErrorHandler, conversion_mode::Replace>
             elt = arg.AsCharUnchecked();
             break;
           case STRING_TYPE_TAG:
-            elt = std::string(arg.AsStringUnchecked());
+            // A value that already is a string keeps its capacity.
+            if(auto str = elt.target<std::string>())
+              str->assign(arg.AsStringUnchecked());
+            else
+              elt = std::string(arg.AsStringUnchecked());
             break;
           case BLOB_TYPE_TAG:
           {
             int n = 0;
             const char* data{};
             arg.AsBlobUnchecked(reinterpret_cast<const void*&>(data), n);
-            elt = coppa::Generic{std::string(data, n)};
+            if(auto gen = elt.target<coppa::Generic>())
+              gen->buf.assign(data, n);
+            else
+              elt = coppa::Generic{std::string(data, n)};
             break;
           }
             // Arrays should be handled elsewhere
@@ -483,6 +574,70 @@ struct value_maker<ErrorHandler, conversion_mode::Replace>
 };
 
 
+// Checks the type tags of a message against the types of the local values
+// in a single pass, without building the expected type tag string.
+// If they match, the message can be read with conversion_mode::Prechecked.
+// A bool matches both 'T' and 'F'.
+inline bool match_type_tags(const Variant& val, const char*& tag, const char* end);
+
+inline bool match_type_tags(const Tuple& tuple, const char*& tag, const char* end)
+{
+  using namespace oscpack;
+  if(tag == end || *tag != ARRAY_BEGIN_TYPE_TAG)
+    return false;
+  ++tag;
+
+  for(const auto& val : tuple.variants)
+  {
+    if(!match_type_tags(val, tag, end))
+      return false;
+  }
+
+  if(tag == end || *tag != ARRAY_END_TYPE_TAG)
+    return false;
+  ++tag;
+  return true;
+}
+
+inline bool match_type_tags(const Variant& val, const char*& tag, const char* end)
+{
+  using namespace oscpack;
+  if(tag == end)
+    return false;
+
+  const char c = *tag;
+  bool ok = false;
+  switch(which(val))
+  {
+    case Type::none_t: ok = c == NIL_TYPE_TAG; break;
+    case Type::impulse_t: ok = c == INFINITUM_TYPE_TAG; break;
+    case Type::bool_t: ok = c == TRUE_TYPE_TAG || c == FALSE_TYPE_TAG; break;
+    case Type::int_t: ok = c == INT32_TYPE_TAG; break;
+    case Type::float_t: ok = c == FLOAT_TYPE_TAG; break;
+    case Type::char_t: ok = c == CHAR_TYPE_TAG; break;
+    case Type::string_t: ok = c == STRING_TYPE_TAG; break;
+    case Type::generic_t: ok = c == BLOB_TYPE_TAG; break;
+    case Type::tuple_t: return match_type_tags(eggs::variants::get<Tuple>(val), tag, end);
+    default: break;
+  }
+
+  ++tag;
+  return ok;
+}
+
+inline bool match_type_tags(const Values& values, const oscpack::ReceivedMessage& m)
+{
+  const char* tag = m.TypeTags();
+  const char* end = tag + m.ArgumentCount();
+  for(const auto& val : values.variants)
+  {
+    if(!match_type_tags(val, tag, end))
+      return false;
+  }
+
+  return tag == end;
+}
+
 // Used to read all the Values in an OSC message.
 template<typename ErrorHandler, conversion_mode Conv>
 struct values_reader;
@@ -491,15 +646,19 @@ struct values_reader;
 template<typename ErrorHandler>
 struct values_reader<ErrorHandler, conversion_mode::Convert>
 {
+    // m is the message of the arguments, if they are all read :
+    // see read_array.
     void operator()(
         oscpack::ReceivedMessageArgumentIterator it,
         oscpack::ReceivedMessageArgumentIterator end_it,
-        Values& source
+        Values& source,
+        const oscpack::ReceivedMessage* m = nullptr
         )
     {
       value_maker<
           ErrorHandler,
           conversion_mode::Convert> converter;
+      converter.message = m;
 
       int max_values = source.variants.size();
       for(int i = 0; it != end_it && i < max_values; i++)
@@ -562,19 +721,48 @@ struct values_reader<ErrorHandler, conversion_mode::Ignore>
 template<typename ErrorHandler>
 struct values_reader<ErrorHandler, conversion_mode::Prechecked>
 {
+    // m is the message of the arguments, if they are all read :
+    // the long runs of int32 or float are then decoded in bulk,
+    // since their types are known to match.
     void operator()(
         oscpack::ReceivedMessageArgumentIterator it,
         oscpack::ReceivedMessageArgumentIterator end_it,
-        Values& source
+        Values& source,
+        const oscpack::ReceivedMessage* m = nullptr
         )
     {
       value_maker<
           ErrorHandler,
           conversion_mode::Prechecked> converter;
+      converter.message = m;
 
-      for(int i = 0; it != end_it; i++)
+      osc::argument_position pos;
+      if(m)
+        pos = osc::arguments_begin(*m);
+
+      for(std::size_t i = 0; it != end_it; )
       {
-        it = converter(it, source.variants[i]);
+        const auto run = pos.tag ? osc::numeric_run(pos.tag) : 0;
+        if(run >= osc::bulk_threshold)
+        {
+          osc::read_numeric_run(pos, run, source.variants, i);
+          pos.tag += run;
+          pos.data += 4 * run;
+          for(std::size_t k = 0; k < run; k++)
+            ++it;
+          i += run;
+        }
+        else
+        {
+          auto& elt = source.variants[i];
+          if(which(elt) == Type::tuple_t)
+            pos = {};
+          else if(pos.tag)
+            pos.advance();
+
+          it = converter(it, elt);
+          i++;
+        }
       }
     }
 };
@@ -29,7 +29,7 @@ struct strict_osc_handler
       using eggs::variants::get;
 
       // First check the compatibility
-      if(getOSCType(current_parameter) != m.TypeTags())
+      if(!match_type_tags(current_parameter, m))
         return;
 
       // Then write the arguments
@@ -38,7 +38,8 @@ struct strict_osc_handler
           conversion_mode::Prechecked>{}(
              m.ArgumentsBegin(),
              m.ArgumentsEnd(),
-             current_parameter);
+             current_parameter,
+             &m);
 
       dev.template update<string_view>(
             address,
@@ -96,12 +97,28 @@ struct convert_osc_handler
       using coppa::minuit::Parameter;
       using eggs::variants::get;
 
-      values_reader<
-          lax_error_handler,
-          conversion_mode::Convert>{}(
-             m.ArgumentsBegin(),
-             m.ArgumentsEnd(),
-             current_parameter);
+      // Streams with a fixed signature take the unchecked path;
+      // the per-argument conversions are only needed on a mismatch.
+      if(match_type_tags(current_parameter, m))
+      {
+        values_reader<
+            lax_error_handler,
+            conversion_mode::Prechecked>{}(
+               m.ArgumentsBegin(),
+               m.ArgumentsEnd(),
+               current_parameter,
+               &m);
+      }
+      else
+      {
+        values_reader<
+            lax_error_handler,
+            conversion_mode::Convert>{}(
+               m.ArgumentsBegin(),
+               m.ArgumentsEnd(),
+               current_parameter,
+               &m);
+      }
 
       dev.template update<string_view>(
             address,
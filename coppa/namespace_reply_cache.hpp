@@ -0,0 +1,97 @@
+#pragma once
+#include <coppa/string_view.hpp>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace coppa
+{
+/**
+ * @brief The namespace_reply_cache class
+ *
+ * Encoded replies to namespace requests, by address.
+ * A reply only depends on the children of its address : inserting or
+ * removing a node invalidates the replies of the node and of its parents,
+ * the other ones stay valid.
+ *
+ * Thread-safe, so that the replies can be looked up without the lock
+ * of the map. The replies must be stored with the read lock of the map
+ * held, so that they cannot miss an invalidation.
+ * Copies are empty.
+ */
+class namespace_reply_cache
+{
+  public:
+    using reply = std::shared_ptr<const std::string>;
+
+    namespace_reply_cache() = default;
+    namespace_reply_cache(const namespace_reply_cache&) { }
+    namespace_reply_cache& operator=(const namespace_reply_cache&)
+    {
+      clear();
+      return *this;
+    }
+
+    reply find(string_view address) const
+    {
+      std::lock_guard<std::mutex> l{m_mutex};
+      auto it = m_replies.find(address);
+      return it != m_replies.end() ? it->second : reply{};
+    }
+
+    void store(string_view address, std::string packet)
+    {
+      auto r = std::make_shared<const std::string>(std::move(packet));
+      std::lock_guard<std::mutex> l{m_mutex};
+      m_replies[std::string(address.data(), address.size())] = std::move(r);
+    }
+
+    // A node was inserted or removed at the address :
+    // the replies for it and for its parents change.
+    void invalidate(string_view address)
+    {
+      std::lock_guard<std::mutex> l{m_mutex};
+      if(m_replies.empty())
+        return;
+      invalidate_parents(address);
+    }
+
+    void clear()
+    {
+      std::lock_guard<std::mutex> l{m_mutex};
+      m_replies.clear();
+    }
+
+    std::size_t size() const
+    {
+      std::lock_guard<std::mutex> l{m_mutex};
+      return m_replies.size();
+    }
+
+  private:
+    // Requires the lock.
+    void invalidate_parents(string_view address)
+    {
+      while(!address.empty())
+      {
+        auto it = m_replies.find(address);
+        if(it != m_replies.end())
+          m_replies.erase(it);
+
+        if(address.size() == 1)
+          break;
+
+        auto pos = address.find_last_of('/');
+        if(pos == string_view::npos)
+          break;
+
+        // The parent of "/a" is "/"
+        address = string_view(address.data(), pos == 0 ? 1 : pos);
+      }
+    }
+
+    mutable std::mutex m_mutex;
+    std::map<std::string, reply, std::less<>> m_replies;
+};
+}
@@ -2,6 +2,7 @@
 #include <coppa/coppa.hpp>
 #include <coppa/oscquery/parameter.hpp>
 #include <coppa/protocol/osc/oscreceiver.hpp>
+#include <coppa/string_view.hpp>
 namespace coppa
 {
 namespace osc
@@ -25,6 +26,10 @@ namespace osc
 class message_handler : public coppa::osc::receiver
 {
   public:
+    // The node is found once, with the write lock held :
+    // the arguments are checked against its values, then decoded
+    // directly into them. The handler of the address, if any,
+    // is called without the lock.
     template<typename Device>
     static void on_messageReceived(
         Device& dev,
@@ -32,68 +37,94 @@ class message_handler : public coppa::osc::receiver
     {
       using namespace coppa;
 
-      oscquery::Parameter v;
-      // Little dance for thread-safe access to the current value
+      oscquery::Parameter notified;
+      bool notify = false;
       {
         auto& map = dev.map();
-        auto&& l = map.acquire_read_lock();
-        auto node_it = map.find(m.AddressPattern());
-        if(node_it == map.end())
+        auto&& l = map.acquire_write_lock();
+        auto& data_map = map.get_data_map();
+        auto node_it = data_map.find_cached(string_view{m.AddressPattern()});
+        if(node_it == data_map.end())
           return;
 
-        v = *node_it;
+        // First check the compatibility
+        if(!compatible(node_it->values, m))
+          return;
+
+        // If everything is okay, we can update the node.
+        data_map.update_in_place(node_it, [&] (oscquery::Parameter& p) {
+          read_values(m, p.values);
+        });
+
+        if(dev.has_handler(node_it->destination))
+        {
+          notified = *node_it;
+          notify = true;
+        }
       }
 
-      // First check the compatibility
-      if(m.ArgumentCount() != v.values.size())
-        return;
+      if(notify)
+        dev.notify(notified);
+    }
+
+  private:
+    static bool compatible(
+        const coppa::vector<oscquery::Variant>& values,
+        const oscpack::ReceivedMessage& m)
+    {
+      if(m.ArgumentCount() != values.size())
+        return false;
 
       int i = 0;
       for(auto it = m.ArgumentsBegin(); it != m.ArgumentsEnd(); ++it, ++i)
       {
         auto tag = it->TypeTag();
-        if(tag != oscquery::getOSCType(v.values[i]))
-          return;
+        auto expected = oscquery::getOSCType(values[i]);
+        if(tag != expected
+           && !(oscquery::which(values[i]) == oscquery::Type::bool_t
+                && (tag == oscpack::TRUE_TYPE_TAG || tag == oscpack::FALSE_TYPE_TAG)))
+          return false;
       }
 
-      // If everything is okay, we can update the device.
-      dev.update(
-            m.AddressPattern(),
-            [&] (auto& v) {
-        int i = 0;
+      return true;
+    }
 
-        for(auto it = m.ArgumentsBegin(); it != m.ArgumentsEnd(); ++it, ++i)
+    // The types have been checked by compatible().
+    static void read_values(
+        const oscpack::ReceivedMessage& m,
+        coppa::vector<oscquery::Variant>& values)
+    {
+      using eggs::variants::get;
+      int i = 0;
+      for(auto it = m.ArgumentsBegin(); it != m.ArgumentsEnd(); ++it, ++i)
+      {
+        auto& elt = values[i];
+        switch(oscquery::which(elt))
         {
-          // Note : how to handle mismatch between received osc messages
-          // and the structure of the tree ?
-          auto& elt = v.values[i];
-          switch(oscquery::which(elt))
+          case oscquery::Type::int_t:
+            elt = it->AsInt32();
+            break;
+          case oscquery::Type::float_t:
+            elt = it->AsFloat();
+            break;
+          case oscquery::Type::bool_t:
+            elt = it->AsBool();
+            break;
+          case oscquery::Type::string_t:
+            get<std::string>(elt).assign(it->AsString());
+            break;
+          case oscquery::Type::generic_t:
           {
-            case oscquery::Type::int_t:
-              elt = it->AsInt32();
-              break;
-            case oscquery::Type::float_t:
-              elt = it->AsFloat();
-              break;
-            case oscquery::Type::bool_t:
-              elt = it->AsBool();
-              break;
-            case oscquery::Type::string_t:
-              elt = std::string(it->AsString());
-              break;
-            case oscquery::Type::generic_t:
-            {
-              int n = 0;
-              const char* data{};
-              it->AsBlob(reinterpret_cast<const void*&>(data), n);
-              elt = coppa::Generic{std::string(data, n)};
-              break;
-            }
-            default:
-              break;
+            int n = 0;
+            const char* data{};
+            it->AsBlob(reinterpret_cast<const void*&>(data), n);
+            get<coppa::Generic>(elt).buf.assign(data, n);
+            break;
           }
+          default:
+            break;
         }
-      });
+      }
     }
 };
 
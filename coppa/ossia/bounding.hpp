@@ -0,0 +1,377 @@
+#pragma once
+#include <coppa/ossia/parameter.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstdint>
+#include <limits>
+
+#if defined(__AVX__) || defined(__SSE4_1__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace coppa
+{
+namespace ossia
+{
+// Bounding of values against [min, max].
+// Clip clamps ; Wrap maps the value periodically into [min, max),
+// Fold goes back and forth between min and max.
+// Integers wrap into [min, max], e.g. 128 wraps to 0 in [0, 127].
+// If max <= min, Wrap and Fold behave like Clip.
+namespace bounding
+{
+// Scalar kernels ; without branches, so that they can be vectorized.
+inline float clip(float x, float min, float max)
+{
+  return std::min(std::max(x, min), max);
+}
+
+inline float wrap(float x, float min, float range, float inv_range)
+{
+  return x - range * std::floor((x - min) * inv_range);
+}
+
+inline float fold(float x, float min, float range, float inv_range)
+{
+  const float t = x - min;
+  const float m = t - 2.f * range * std::floor(t * 0.5f * inv_range);
+  return min + range - std::abs(m - range);
+}
+
+inline int32_t clip(int32_t x, int32_t min, int32_t max)
+{
+  return std::min(std::max(x, min), max);
+}
+
+inline int32_t wrap(int32_t x, int32_t min, int64_t period)
+{
+  int64_t m = (int64_t(x) - min) % period;
+  m += period & -int64_t(m < 0);
+  return int32_t(min + m);
+}
+
+inline int32_t fold(int32_t x, int32_t min, int64_t range)
+{
+  const int64_t period = 2 * range;
+  int64_t m = (int64_t(x) - min) % period;
+  m += period & -int64_t(m < 0);
+  return int32_t(min + range - std::abs(m - range));
+}
+
+/**
+ * @brief Bounds an array of floats in place.
+ *
+ * Uses AVX, SSE4.1 or NEON (AArch64) when they are enabled,
+ * e.g. with the OPTIMIZED build option.
+ */
+inline void bound_floats(
+    float* data,
+    std::size_t n,
+    Bounding::Mode mode,
+    float min,
+    float max)
+{
+  if(mode == Bounding::Mode::Free)
+    return;
+
+  const float range = max - min;
+  if(!(range > 0.f))
+    mode = Bounding::Mode::Clip;
+  const float inv_range = 1.f / range;
+
+  std::size_t i = 0;
+
+#if defined(__AVX__)
+  {
+    const __m256 vmin = _mm256_set1_ps(min);
+    const __m256 vmax = _mm256_set1_ps(max);
+    const __m256 vrange = _mm256_set1_ps(range);
+    const __m256 vinv = _mm256_set1_ps(inv_range);
+    const __m256 vhalf_inv = _mm256_set1_ps(0.5f * inv_range);
+    const __m256 vperiod = _mm256_set1_ps(2.f * range);
+    const __m256 vsign = _mm256_set1_ps(-0.f);
+    for(; i + 8 <= n; i += 8)
+    {
+      __m256 x = _mm256_loadu_ps(data + i);
+      switch(mode)
+      {
+        case Bounding::Mode::Clip:
+          x = _mm256_min_ps(_mm256_max_ps(x, vmin), vmax);
+          break;
+        case Bounding::Mode::Wrap:
+        {
+          auto f = _mm256_floor_ps(_mm256_mul_ps(_mm256_sub_ps(x, vmin), vinv));
+          x = _mm256_sub_ps(x, _mm256_mul_ps(vrange, f));
+          break;
+        }
+        case Bounding::Mode::Fold:
+        {
+          auto t = _mm256_sub_ps(x, vmin);
+          auto f = _mm256_floor_ps(_mm256_mul_ps(t, vhalf_inv));
+          auto m = _mm256_sub_ps(t, _mm256_mul_ps(vperiod, f));
+          auto d = _mm256_andnot_ps(vsign, _mm256_sub_ps(m, vrange));
+          x = _mm256_sub_ps(_mm256_add_ps(vmin, vrange), d);
+          break;
+        }
+        default:
+          break;
+      }
+      _mm256_storeu_ps(data + i, x);
+    }
+  }
+#endif
+
+#if defined(__SSE4_1__)
+  {
+    const __m128 vmin = _mm_set1_ps(min);
+    const __m128 vmax = _mm_set1_ps(max);
+    const __m128 vrange = _mm_set1_ps(range);
+    const __m128 vinv = _mm_set1_ps(inv_range);
+    const __m128 vhalf_inv = _mm_set1_ps(0.5f * inv_range);
+    const __m128 vperiod = _mm_set1_ps(2.f * range);
+    const __m128 vsign = _mm_set1_ps(-0.f);
+    for(; i + 4 <= n; i += 4)
+    {
+      __m128 x = _mm_loadu_ps(data + i);
+      switch(mode)
+      {
+        case Bounding::Mode::Clip:
+          x = _mm_min_ps(_mm_max_ps(x, vmin), vmax);
+          break;
+        case Bounding::Mode::Wrap:
+        {
+          auto f = _mm_floor_ps(_mm_mul_ps(_mm_sub_ps(x, vmin), vinv));
+          x = _mm_sub_ps(x, _mm_mul_ps(vrange, f));
+          break;
+        }
+        case Bounding::Mode::Fold:
+        {
+          auto t = _mm_sub_ps(x, vmin);
+          auto f = _mm_floor_ps(_mm_mul_ps(t, vhalf_inv));
+          auto m = _mm_sub_ps(t, _mm_mul_ps(vperiod, f));
+          auto d = _mm_andnot_ps(vsign, _mm_sub_ps(m, vrange));
+          x = _mm_sub_ps(_mm_add_ps(vmin, vrange), d);
+          break;
+        }
+        default:
+          break;
+      }
+      _mm_storeu_ps(data + i, x);
+    }
+  }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+  {
+    const float32x4_t vmin = vdupq_n_f32(min);
+    const float32x4_t vmax = vdupq_n_f32(max);
+    const float32x4_t vrange = vdupq_n_f32(range);
+    const float32x4_t vinv = vdupq_n_f32(inv_range);
+    const float32x4_t vhalf_inv = vdupq_n_f32(0.5f * inv_range);
+    const float32x4_t vperiod = vdupq_n_f32(2.f * range);
+    for(; i + 4 <= n; i += 4)
+    {
+      float32x4_t x = vld1q_f32(data + i);
+      switch(mode)
+      {
+        case Bounding::Mode::Clip:
+          x = vminq_f32(vmaxq_f32(x, vmin), vmax);
+          break;
+        case Bounding::Mode::Wrap:
+        {
+          auto f = vrndmq_f32(vmulq_f32(vsubq_f32(x, vmin), vinv));
+          x = vsubq_f32(x, vmulq_f32(vrange, f));
+          break;
+        }
+        case Bounding::Mode::Fold:
+        {
+          auto t = vsubq_f32(x, vmin);
+          auto f = vrndmq_f32(vmulq_f32(t, vhalf_inv));
+          auto m = vsubq_f32(t, vmulq_f32(vperiod, f));
+          x = vsubq_f32(vaddq_f32(vmin, vrange), vabsq_f32(vsubq_f32(m, vrange)));
+          break;
+        }
+        default:
+          break;
+      }
+      vst1q_f32(data + i, x);
+    }
+  }
+#endif
+
+  switch(mode)
+  {
+    case Bounding::Mode::Clip:
+      for(; i < n; i++)
+        data[i] = clip(data[i], min, max);
+      break;
+    case Bounding::Mode::Wrap:
+      for(; i < n; i++)
+        data[i] = wrap(data[i], min, range, inv_range);
+      break;
+    case Bounding::Mode::Fold:
+      for(; i < n; i++)
+        data[i] = fold(data[i], min, range, inv_range);
+      break;
+    default:
+      break;
+  }
+}
+
+inline void bound_ints(
+    int32_t* data,
+    std::size_t n,
+    Bounding::Mode mode,
+    int32_t min,
+    int32_t max)
+{
+  if(max <= min)
+    mode = Bounding::Mode::Clip;
+
+  // Computed in 64 bits : max - min can overflow.
+  const int64_t range = int64_t(max) - min;
+  switch(mode)
+  {
+    case Bounding::Mode::Clip:
+      for(std::size_t i = 0; i < n; i++)
+        data[i] = clip(data[i], min, max);
+      break;
+    case Bounding::Mode::Wrap:
+      for(std::size_t i = 0; i < n; i++)
+        data[i] = wrap(data[i], min, range + 1);
+      break;
+    case Bounding::Mode::Fold:
+      for(std::size_t i = 0; i < n; i++)
+        data[i] = fold(data[i], min, range);
+      break;
+    default:
+      break;
+  }
+}
+
+// A bound of the range, as a number ; an unset bound (None) is infinite.
+inline bool numeric_bound(const Variant& v, float inf, float& res)
+{
+  using namespace eggs::variants;
+  switch(which(v))
+  {
+    case Type::int_t:
+      res = float(get<int32_t>(v));
+      return true;
+    case Type::float_t:
+      res = get<float>(v);
+      return true;
+    case Type::none_t:
+      res = inf;
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Saturates an integral float, e.g. an infinite bound, to an int32_t.
+inline int32_t to_int_bound(float f)
+{
+  const float lo = float(std::numeric_limits<int32_t>::min());
+  const float hi = float(std::numeric_limits<int32_t>::max());
+  return f <= lo ? std::numeric_limits<int32_t>::min()
+       : f >= hi ? std::numeric_limits<int32_t>::max()
+       : int32_t(f);
+}
+
+inline void bound_tuple(Tuple& t, Bounding::Mode mode, float min, float max);
+
+inline void bound_variant(Variant& v, Bounding::Mode mode, float min, float max)
+{
+  using namespace eggs::variants;
+  switch(which(v))
+  {
+    // The bounds of the integers are rounded inwards.
+    case Type::int_t:
+      bound_ints(&get<int32_t>(v), 1, mode, to_int_bound(std::ceil(min)), to_int_bound(std::floor(max)));
+      break;
+    case Type::float_t:
+      bound_floats(&get<float>(v), 1, mode, min, max);
+      break;
+    case Type::tuple_t:
+      bound_tuple(get<Tuple>(v), mode, min, max);
+      break;
+    case Type::float_array_t:
+    {
+      auto& arr = get<float_array>(v);
+      bound_floats(arr.data(), arr.size(), mode, min, max);
+      break;
+    }
+    case Type::int_array_t:
+    {
+      auto& arr = get<int_array>(v);
+      bound_ints(arr.data(), arr.size(), mode, to_int_bound(std::ceil(min)), to_int_bound(std::floor(max)));
+      break;
+    }
+    case Type::vec2f_t:
+      bound_floats(get<vec2f>(v).data(), 2, mode, min, max);
+      break;
+    case Type::vec3f_t:
+      bound_floats(get<vec3f>(v).data(), 3, mode, min, max);
+      break;
+    case Type::vec4f_t:
+      bound_floats(get<vec4f>(v).data(), 4, mode, min, max);
+      break;
+    default:
+      // Not numeric
+      break;
+  }
+}
+
+inline void bound_tuple(Tuple& t, Bounding::Mode mode, float min, float max)
+{
+  auto& vars = t.variants;
+  const auto n = vars.size();
+  for(std::size_t i = 0; i < n; i++)
+  {
+    bound_variant(vars[i], mode, min, max);
+  }
+}
+}
+
+/**
+ * @brief Applies a bounding mode to a value.
+ *
+ * The range bounds must be numbers (int or float) ;
+ * an unset bound (None) is infinite, which only makes sense with Clip.
+ * Tuples and arrays are bounded element-wise.
+ * Returns false if the value could not be bounded.
+ */
+inline bool apply_bounding(
+    Bounding::Mode mode,
+    const Range& range,
+    Variant& value)
+{
+  if(mode == Bounding::Mode::Free)
+    return true;
+
+  const float inf = std::numeric_limits<float>::infinity();
+  float min, max;
+  if(!bounding::numeric_bound(range.min, -inf, min)
+     || !bounding::numeric_bound(range.max, inf, max))
+    return false;
+
+  if(mode != Bounding::Mode::Clip && (std::isinf(min) || std::isinf(max)))
+    return false;
+
+  bounding::bound_variant(value, mode, min, max);
+  return true;
+}
+
+// Bounds the value of a parameter according to its own range and mode.
+template<typename Parameter_T>
+void apply_bounding(Parameter_T& p)
+{
+  if(p.bounding != Bounding::Mode::Free)
+    apply_bounding(p.bounding, static_cast<const Range&>(p), p.value);
+}
+
+}
+}
@@ -1,6 +1,7 @@
 #pragma once
 #include <nano-signal-slot/nano_signal_slot.hpp>
 #include <coppa/ossia/parameter.hpp>
+#include <coppa/ossia/osc/value_view.hpp>
 #include <unordered_map>
 
 namespace coppa
@@ -24,6 +25,13 @@ class device_with_callbacks
           return m_callbacks[dest];
         }
 
+        // The callbacks of an address, or nullptr if there are none.
+        auto find_value_callback(const std::string& dest)
+        {
+          auto it = m_callbacks.find(dest);
+          return it != m_callbacks.end() ? &it->second : nullptr;
+        }
+
         template<typename Arg, typename... TArgs>
         void add_value_callback(const std::string& dest, const Arg& arg)
         {
@@ -36,6 +44,32 @@ class device_with_callbacks
           m_callbacks[dest].template disconnect<TArgs...>(arg);
         }
 
+        // The view callbacks get the received arguments without copy :
+        // strings and blobs point into the packet buffer.
+        // The local value is still updated.
+        auto& get_view_callback(const std::string& dest)
+        {
+          return m_view_callbacks[dest];
+        }
+
+        auto find_view_callback(const std::string& dest)
+        {
+          auto it = m_view_callbacks.find(dest);
+          return it != m_view_callbacks.end() ? &it->second : nullptr;
+        }
+
+        template<typename Arg, typename... TArgs>
+        void add_view_callback(const std::string& dest, const Arg& arg)
+        {
+          m_view_callbacks[dest].template connect<TArgs...>(arg);
+        }
+
+        template<typename Arg, typename... TArgs>
+        void remove_view_callback(const std::string& dest, const Arg& arg)
+        {
+          m_view_callbacks[dest].template disconnect<TArgs...>(arg);
+        }
+
     private:
         void callback_helper(Parameter p)
         {
@@ -47,6 +81,7 @@ class device_with_callbacks
         }
 
         std::unordered_map<std::string, Nano::Signal<void(coppa::ossia::Value)>> m_callbacks;
+        std::unordered_map<std::string, Nano::Signal<void(const value_view&)>> m_view_callbacks;
 };
 
 }
@@ -34,76 +34,90 @@ class minuit_message_handler :
         string_view address,
         const oscpack::ReceivedMessage& m)
     {
-      // Look for either ':' or '?'
-      auto idx = address.find_first_of(":?!");
+      if(auto action = parse_action(address, m))
+        handleMinuitMessage(dev, map, *action, m);
+    }
+
+    // The action of a Minuit message, or none if it is malformed.
+    static boost::optional<minuit_action> parse_action(
+        string_view address,
+        const oscpack::ReceivedMessage& m)
+    {
+      // The first argument of every Minuit message is an address.
+      if(m.ArgumentCount() == 0 || !m.ArgumentsBegin()->IsString())
+        return boost::none;
 
-      if(idx != std::string::npos)
+      return find_action(address);
+    }
+
+    template<typename Device, typename Map>
+    static void handleMinuitMessage(
+        Device& dev,
+        Map& map,
+        minuit_action action,
+        const oscpack::ReceivedMessage& m)
+    {
+      switch(action)
       {
-        auto req = get_command(address[idx]);
-        auto op = get_operation(*(address.data() + idx + 1));
-        switch(req)
-        {
-          case minuit_command::Answer: // Receiving an answer
-          {
-            switch(op)
-            {
-              case minuit_operation::Listen:
-                Handler<minuit_command::Answer, minuit_operation::Listen>{}(dev, map, m);
-                break;
-              case minuit_operation::Get:
-                Handler<minuit_command::Answer, minuit_operation::Get>{}(dev, map, m);
-                break;
-              case minuit_operation::Namespace:
-                Handler<minuit_command::Answer, minuit_operation::Namespace>{}(dev, map, m);
-                break;
-              default:
-                break;
-            }
-            break;
-          }
-          case minuit_command::Request: // Receiving a request
-          {
-            switch(op)
-            {
-              case minuit_operation::Listen:
-                Handler<minuit_command::Request, minuit_operation::Listen>{}(dev, map, m);
-                break;
-              case minuit_operation::Get:
-                Handler<minuit_command::Request, minuit_operation::Get>{}(dev, map, m);
-                break;
-              case minuit_operation::Namespace:
-                Handler<minuit_command::Request, minuit_operation::Namespace>{}(dev, map, m);
-                break;
-              default:
-                break;
-            }
-            break;
-          }
-          case minuit_command::Error: // Receiving an error
-          {
-            switch(op)
-            {
-              case minuit_operation::Listen:
-                Handler<minuit_command::Error, minuit_operation::Listen>{}(dev, map, m);
-                break;
-              case minuit_operation::Get:
-                Handler<minuit_command::Error, minuit_operation::Get>{}(dev, map, m);
-                break;
-              case minuit_operation::Namespace:
-                Handler<minuit_command::Error, minuit_operation::Namespace>{}(dev, map, m);
-                break;
-              default:
-                break;
-            }
-            break;
-          }
-          default:
-            break;
-        }
+        case minuit_action::NamespaceRequest:
+          Handler<minuit_command::Request, minuit_operation::Namespace>{}(dev, map, m);
+          break;
+        case minuit_action::NamespaceReply:
+          Handler<minuit_command::Answer, minuit_operation::Namespace>{}(dev, map, m);
+          break;
+        case minuit_action::NamespaceError:
+          Handler<minuit_command::Error, minuit_operation::Namespace>{}(dev, map, m);
+          break;
+        case minuit_action::GetRequest:
+          Handler<minuit_command::Request, minuit_operation::Get>{}(dev, map, m);
+          break;
+        case minuit_action::GetReply:
+          Handler<minuit_command::Answer, minuit_operation::Get>{}(dev, map, m);
+          break;
+        case minuit_action::GetError:
+          Handler<minuit_command::Error, minuit_operation::Get>{}(dev, map, m);
+          break;
+        case minuit_action::ListenRequest:
+          Handler<minuit_command::Request, minuit_operation::Listen>{}(dev, map, m);
+          break;
+        case minuit_action::ListenReply:
+          Handler<minuit_command::Answer, minuit_operation::Listen>{}(dev, map, m);
+          break;
+        case minuit_action::ListenError:
+          Handler<minuit_command::Error, minuit_operation::Listen>{}(dev, map, m);
+          break;
+        case minuit_action::DumpRequest:
+          Handler<minuit_command::Request, minuit_operation::Dump>{}(dev, map, m);
+          break;
+        case minuit_action::DumpReply:
+          Handler<minuit_command::Answer, minuit_operation::Dump>{}(dev, map, m);
+          break;
+        case minuit_action::DumpError:
+          Handler<minuit_command::Error, minuit_operation::Dump>{}(dev, map, m);
+          break;
       }
+    }
 
-      // For minuit address, the request is the address pattern,
-      // and the arugments may contain the address of type 's', and the OSC stuff.
+    // The reply to a namespace request, if it was already built
+    // and the map did not change under the requested address since.
+    template<typename Device, typename Map>
+    static namespace_reply_cache::reply cached_namespace_reply(
+        Device& dev,
+        Map& map,
+        const oscpack::ReceivedMessage& m)
+    {
+      auto reply = map.get_data_map().namespace_replies().find(m.ArgumentsBegin()->AsString());
+      if(!reply)
+        return {};
+
+      // The map may be shared by devices with other names.
+      const auto action = dev.nameTable.get_action(minuit_action::NamespaceReply);
+      if(reply->size() <= action.size()
+         || reply->compare(0, action.size(), action.data(), action.size()) != 0
+         || (*reply)[action.size()] != '\0')
+        return {};
+
+      return reply;
     }
 
     template<typename Device, typename Map>
@@ -118,13 +132,28 @@ class minuit_message_handler :
       // We have to check if it's a plain osc address, or a Minuit request address.
       if(address.size() > 0 && address[0] == '/')
       {
-        convert_osc_handler{}(dev, map.get(address), address, m);
+        convert_osc_handler{}(dev, map, address, m);
       }
       else
       {
         // Handling of the Minuit protocol
+        auto action = parse_action(address, m);
+        if(!action)
+          return;
+
+        // The namespace requests repeat a lot, e.g. when a remote reconnects :
+        // their replies are sent again without locking nor reading the map.
+        if(*action == minuit_action::NamespaceRequest)
+        {
+          if(auto reply = cached_namespace_reply(dev, map, m))
+          {
+            dev.sender.send_raw(reply->data(), reply->size());
+            return;
+          }
+        }
+
         auto l = map.acquire_read_lock();
-        handleMinuitMessage(dev, map.get_data_map(), address, m);
+        handleMinuitMessage(dev, map.get_data_map(), *action, m);
       }
     }
 };
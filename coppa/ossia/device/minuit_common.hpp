@@ -1,6 +1,9 @@
 #pragma once
 #include <coppa/ossia/parameter.hpp>
 #include <coppa/string_view.hpp>
+#include <boost/optional.hpp>
+#include <cstdint>
+#include <cstring>
 
 namespace coppa
 {
@@ -10,8 +13,9 @@ namespace ossia
 enum class minuit_command : char
 { Request = '?', Answer = ':', Error = '!' };
 
+// Dump is an extension, see minuit_name_table::set_dump_extension.
 enum class minuit_operation : char
-{ Listen = 'l', Namespace = 'n', Get = 'g'};
+{ Listen = 'l', Namespace = 'n', Get = 'g', Dump = 'd' };
 
 enum class minuit_action : int {
   NamespaceRequest,
@@ -22,7 +26,10 @@ enum class minuit_action : int {
   GetError,
   ListenRequest,
   ListenReply,
-  ListenError
+  ListenError,
+  DumpRequest,
+  DumpReply,
+  DumpError
 };
 
 enum class minuit_type : char
@@ -66,6 +73,21 @@ inline string_view to_minuit_type_text(const coppa::ossia::Parameter& parameter)
       string_view operator()(const Generic& ) const {
         return "generic";
       }
+      string_view operator()(const float_array& ) const {
+        return "array";
+      }
+      string_view operator()(const int_array& ) const {
+        return "array";
+      }
+      string_view operator()(const vec2f& ) const {
+        return "array";
+      }
+      string_view operator()(const vec3f& ) const {
+        return "array";
+      }
+      string_view operator()(const vec4f& ) const {
+        return "array";
+      }
 
   } visitor;
 
@@ -204,38 +226,180 @@ inline string_view to_minuit_attribute_text(minuit_attribute str)
   }
 }
 
-inline minuit_attribute get_attribute(string_view str)
+/**
+ * @brief The minuit_hash_table class
+ *
+ * Perfect hash table over a fixed set of names, built at compile time :
+ * the seed of the hash is searched so that no two names share a slot.
+ * A lookup is then one hash, one probe and one comparison, and unknown
+ * names are rejected without branching on their characters.
+ */
+template<typename T, std::size_t Slots>
+class minuit_hash_table
 {
-  // requires str.size() > 0
-  switch(str[0])
-  {
-    case 'v': // value
-      return minuit_attribute::Value;
-    case 't': // type
-      return minuit_attribute::Type;
-    case 's': // service
-      return minuit_attribute::Service;
-    case 'p': // priority
-      return minuit_attribute::Priority;
-    case 'r':
+    static_assert((Slots & (Slots - 1)) == 0, "Slots must be a power of two");
+
+  public:
+    struct name
+    {
+        const char* text;
+        T value;
+    };
+
+    template<std::size_t N>
+    constexpr minuit_hash_table(const name (&names)[N])
     {
-      if(str.size() >= 6)
+      static_assert(N <= Slots, "Not enough slots");
+      while(!try_seed(names))
+        m_seed++;
+    }
+
+    boost::optional<T> find(string_view str) const
+    {
+      const auto& s = m_slots[hash(m_seed, str.data(), str.size()) & (Slots - 1)];
+      if(s.text
+         && s.size == str.size()
+         && std::memcmp(s.text, str.data(), str.size()) == 0)
+        return s.value;
+      return boost::none;
+    }
+
+  private:
+    struct slot
+    {
+        const char* text{};
+        std::size_t size{};
+        T value{};
+    };
+
+    // FNV-1a, seeded ; the high bits are mixed in the low ones
+    // which index the slots.
+    static constexpr uint32_t hash(uint32_t seed, const char* str, std::size_t n)
+    {
+      uint32_t h = 2166136261u ^ seed;
+      for(std::size_t i = 0; i < n; i++)
       {
-        switch(str[5])
-        {
-          case 'B': // rangeBounds
-            return minuit_attribute::RangeBounds;
-          case 'C': // rangeClipMode
-            return minuit_attribute::RangeClipMode;
-          case 'i': // repetitionsFilter
-            return minuit_attribute::RepetitionFilter;
-        }
+        h ^= static_cast<unsigned char>(str[i]);
+        h *= 16777619u;
       }
-      // if not returning, throw
+      return h ^ (h >> 15);
     }
-    default:
-      throw std::runtime_error("unhandled attribute");
+
+    template<std::size_t N>
+    constexpr bool try_seed(const name (&names)[N])
+    {
+      for(auto& s : m_slots)
+        s = slot{};
+
+      for(std::size_t i = 0; i < N; i++)
+      {
+        std::size_t n = 0;
+        while(names[i].text[n])
+          n++;
+
+        auto& s = m_slots[hash(m_seed, names[i].text, n) & (Slots - 1)];
+        if(s.text)
+          return false;
+        s = slot{names[i].text, n, names[i].value};
+      }
+      return true;
+    }
+
+    uint32_t m_seed{};
+    slot m_slots[Slots]{};
+};
+
+/**
+ * @brief find_attribute
+ * @return The attribute, or none if str is not a known attribute name.
+ *
+ * The spellings found in the wild are accepted
+ * (e.g. repetitionsFilter and repetitionFilter).
+ */
+inline boost::optional<minuit_attribute> find_attribute(string_view str)
+{
+  using table_t = minuit_hash_table<minuit_attribute, 16>;
+  static constexpr table_t table{{
+      {"value",             minuit_attribute::Value},
+      {"type",              minuit_attribute::Type},
+      {"service",           minuit_attribute::Service},
+      {"priority",          minuit_attribute::Priority},
+      {"rangeBounds",       minuit_attribute::RangeBounds},
+      {"rangeClipmode",     minuit_attribute::RangeClipMode},
+      {"rangeClipMode",     minuit_attribute::RangeClipMode},
+      {"clipMode",          minuit_attribute::RangeClipMode},
+      {"description",       minuit_attribute::Description},
+      {"repetitionsFilter", minuit_attribute::RepetitionFilter},
+      {"repetitionFilter",  minuit_attribute::RepetitionFilter}
+  }};
+
+  return table.find(str);
+}
+
+inline minuit_attribute get_attribute(string_view str)
+{
+  if(auto attr = find_attribute(str))
+    return *attr;
+  throw std::runtime_error("unhandled attribute");
+}
+
+/**
+ * @brief find_action
+ * @param address The address of a Minuit message, e.g. "name?namespace".
+ * The name is the one of the device which sent the message.
+ *
+ * @return The action, or none if the address is not a Minuit action.
+ */
+inline boost::optional<minuit_action> find_action(string_view address)
+{
+  using table_t = minuit_hash_table<minuit_action, 16>;
+  static constexpr table_t table{{
+      {"?namespace", minuit_action::NamespaceRequest},
+      {":namespace", minuit_action::NamespaceReply},
+      {"!namespace", minuit_action::NamespaceError},
+      {"?get",       minuit_action::GetRequest},
+      {":get",       minuit_action::GetReply},
+      {"!get",       minuit_action::GetError},
+      {"?listen",    minuit_action::ListenRequest},
+      {":listen",    minuit_action::ListenReply},
+      {"!listen",    minuit_action::ListenError},
+      {"?dump",      minuit_action::DumpRequest},
+      {":dump",      minuit_action::DumpReply},
+      {"!dump",      minuit_action::DumpError}
+  }};
+
+  auto idx = address.find_first_of(":?!");
+  if(idx == string_view::npos)
+    return boost::none;
+
+  return table.find(address.substr(idx));
+}
+
+/**
+ * @brief split_attribute
+ * Splits "/address:attribute" ; the attribute is the value if there is none.
+ * @return false if the attribute is empty or unknown.
+ */
+inline bool split_attribute(
+    string_view full_address,
+    string_view& address,
+    minuit_attribute& attr)
+{
+  auto idx = full_address.find_first_of(':');
+  if(idx == string_view::npos)
+  {
+    address = full_address;
+    attr = minuit_attribute::Value;
+    return true;
+  }
+
+  address = full_address.substr(0, idx);
+  if(auto a = find_attribute(full_address.substr(idx + 1)))
+  {
+    attr = *a;
+    return true;
   }
+  return false;
 }
 
 inline minuit_command get_command(char str)
@@ -272,6 +436,7 @@ inline minuit_operation get_operation(char str)
     case 'l':
     case 'n':
     case 'g':
+    case 'd':
       return static_cast<minuit_operation>(str);
     default :
       throw std::runtime_error("unhandled operation");
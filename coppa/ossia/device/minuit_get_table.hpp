@@ -0,0 +1,339 @@
+#pragma once
+#include <coppa/ossia/parameter.hpp>
+#include <coppa/exceptions/Timeout.hpp>
+#include <coppa/string_view.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace coppa
+{
+namespace ossia
+{
+/**
+ * @brief The minuit_get_table class
+ *
+ * The pending ?get requests of a remote device, by address.
+ * All the pulls of an address are fulfilled by the next reply for it.
+ * A pull without reply before its deadline fails with a TimeoutException ;
+ * a thread waits for the deadlines while pulls are pending.
+ *
+ * The table is split in shards by hash of the address, each with its
+ * own lock, so that the pulls made by many threads and the replies
+ * handled by the receiver thread rarely wait for each other.
+ * The timer thread is only woken when a pull has an earlier deadline
+ * than the one it waits for.
+ */
+class minuit_get_table
+{
+  public:
+    using clock = std::chrono::steady_clock;
+    static const constexpr std::size_t shard_count = 16;
+
+    ~minuit_get_table()
+    {
+      {
+        std::lock_guard<std::mutex> l{m_timer_mutex};
+        m_running = false;
+      }
+      m_cv.notify_one();
+      if(m_thread.joinable())
+        m_thread.join();
+    }
+
+    // first is true if no pull of this address was pending,
+    // i.e. if the request has to be sent.
+    std::pair<std::future<Parameter>, bool> add(
+        const std::string& address,
+        clock::time_point deadline)
+    {
+      std::pair<std::future<Parameter>, bool> res;
+      {
+        auto& s = shard_for(address);
+        std::lock_guard<std::mutex> l{s.mutex};
+        auto& w = push_waiter(s, address, deadline);
+        res.first = w.promise.get_future();
+        res.second = s.entries[address].size() == 1;
+      }
+      wake_timer(deadline);
+      return res;
+    }
+
+    // Same, for several addresses whose values are all needed.
+    // The future fails as soon as one of them times out.
+    // Returns the future and the addresses to request.
+    std::pair<std::future<std::vector<Parameter>>, std::vector<std::string>> add_many(
+        const std::vector<std::string>& addresses,
+        clock::time_point deadline)
+    {
+      auto batch = std::make_shared<pull_batch>();
+      batch->results.resize(addresses.size());
+      batch->remaining = addresses.size();
+      auto fut = batch->promise.get_future();
+
+      std::vector<std::string> to_send;
+      if(addresses.empty())
+      {
+        batch->promise.set_value({});
+        return {std::move(fut), std::move(to_send)};
+      }
+
+      for(std::size_t i = 0; i < addresses.size(); i++)
+      {
+        auto& s = shard_for(addresses[i]);
+        std::lock_guard<std::mutex> l{s.mutex};
+        auto& w = push_waiter(s, addresses[i], deadline);
+        w.batch = batch;
+        w.index = i;
+        if(s.entries[addresses[i]].size() == 1)
+          to_send.push_back(addresses[i]);
+      }
+
+      wake_timer(deadline);
+      return {std::move(fut), std::move(to_send)};
+    }
+
+    // A reply for the address was received.
+    void fulfill(const std::string& address, const Parameter& p)
+    {
+      std::vector<waiter> waiters;
+      {
+        auto& s = shard_for(address);
+        std::lock_guard<std::mutex> l{s.mutex};
+        auto it = s.entries.find(address);
+        if(it == s.entries.end())
+          return;
+
+        waiters = std::move(it->second);
+        s.entries.erase(it);
+      }
+
+      for(auto& w : waiters)
+      {
+        if(w.batch)
+        {
+          auto& b = *w.batch;
+          std::lock_guard<std::mutex> l{b.mutex};
+          if(b.failed)
+            continue;
+          b.results[w.index] = p;
+          if(--b.remaining == 0)
+            b.promise.set_value(std::move(b.results));
+        }
+        else
+        {
+          w.promise.set_value(p);
+        }
+      }
+    }
+
+    // Fails the pulls whose deadline is before now.
+    // Called by the table's thread ; public so that it can be driven by hand.
+    void expire(clock::time_point now)
+    {
+      for(auto& s : m_shards)
+        expire_shard(s, now);
+    }
+
+    std::size_t pending() const
+    {
+      std::size_t n = 0;
+      for(auto& s : m_shards)
+      {
+        std::lock_guard<std::mutex> l{s.mutex};
+        for(const auto& e : s.entries)
+          n += e.second.size();
+      }
+      return n;
+    }
+
+  private:
+    struct pull_batch
+    {
+        std::mutex mutex;
+        std::vector<Parameter> results;
+        std::size_t remaining{};
+        std::promise<std::vector<Parameter>> promise;
+        bool failed{};
+    };
+
+    struct waiter
+    {
+        uint64_t id{};
+        clock::time_point deadline;
+        std::promise<Parameter> promise;
+
+        // Set for the pulls made by add_many.
+        std::shared_ptr<pull_batch> batch;
+        std::size_t index{};
+    };
+
+    struct deadline_entry
+    {
+        clock::time_point deadline;
+        uint64_t id;
+        std::string address;
+
+        bool operator>(const deadline_entry& other) const
+        { return deadline > other.deadline; }
+    };
+
+    struct shard
+    {
+        mutable std::mutex mutex;
+        std::unordered_map<std::string, std::vector<waiter>> entries;
+        std::priority_queue<
+            deadline_entry,
+            std::vector<deadline_entry>,
+            std::greater<deadline_entry>> deadlines;
+        uint64_t next_id{};
+    };
+
+    shard& shard_for(const std::string& address)
+    {
+      return m_shards[std::hash<std::string>{}(address) % shard_count];
+    }
+
+    // Requires the lock of the shard.
+    waiter& push_waiter(shard& s, const std::string& address, clock::time_point deadline)
+    {
+      const auto id = s.next_id++;
+      auto& waiters = s.entries[address];
+      waiters.emplace_back();
+      auto& w = waiters.back();
+      w.id = id;
+      w.deadline = deadline;
+
+      // The fulfilled waiters stay in the heap until their deadline,
+      // and are skipped then.
+      s.deadlines.push({deadline, id, address});
+      return w;
+    }
+
+    void wake_timer(clock::time_point deadline)
+    {
+      if(deadline.time_since_epoch().count() >= m_next_wake.load(std::memory_order_acquire))
+        return;
+
+      {
+        std::lock_guard<std::mutex> l{m_timer_mutex};
+        if(!m_thread.joinable())
+          m_thread = std::thread([this] { run(); });
+        m_generation++;
+      }
+      m_cv.notify_one();
+    }
+
+    void expire_shard(shard& s, clock::time_point now)
+    {
+      std::vector<std::pair<waiter, std::string>> expired;
+      {
+        std::lock_guard<std::mutex> l{s.mutex};
+        while(!s.deadlines.empty() && s.deadlines.top().deadline <= now)
+        {
+          auto d = s.deadlines.top();
+          s.deadlines.pop();
+
+          auto it = s.entries.find(d.address);
+          if(it == s.entries.end())
+            continue;
+
+          auto& waiters = it->second;
+          auto w_it = std::find_if(waiters.begin(), waiters.end(),
+                                   [&] (const waiter& w) { return w.id == d.id; });
+          if(w_it == waiters.end())
+            continue;
+
+          expired.emplace_back(std::move(*w_it), std::move(d.address));
+          waiters.erase(w_it);
+          if(waiters.empty())
+            s.entries.erase(it);
+        }
+      }
+
+      for(auto& e : expired)
+      {
+        auto err = std::make_exception_ptr(TimeoutException{e.second});
+        auto& w = e.first;
+        if(w.batch)
+        {
+          auto& b = *w.batch;
+          std::lock_guard<std::mutex> l{b.mutex};
+          if(!b.failed)
+          {
+            b.failed = true;
+            b.promise.set_exception(err);
+          }
+        }
+        else
+        {
+          w.promise.set_exception(err);
+        }
+      }
+    }
+
+    // Earliest deadline in the shards, or max() if none.
+    clock::time_point next_deadline() const
+    {
+      auto next = clock::time_point::max();
+      for(auto& s : m_shards)
+      {
+        std::lock_guard<std::mutex> l{s.mutex};
+        if(!s.deadlines.empty())
+          next = std::min(next, s.deadlines.top().deadline);
+      }
+      return next;
+    }
+
+    void run()
+    {
+      std::unique_lock<std::mutex> l{m_timer_mutex};
+      while(m_running)
+      {
+        // While the shards are scanned, every new pull wakes the thread.
+        m_next_wake.store(clock::time_point::max().time_since_epoch().count(), std::memory_order_release);
+        const auto generation = m_generation;
+        l.unlock();
+
+        expire(clock::now());
+        const auto next = next_deadline();
+
+        l.lock();
+        if(generation != m_generation)
+          continue;
+
+        m_next_wake.store(next.time_since_epoch().count(), std::memory_order_release);
+        const auto woken = [&] { return !m_running || generation != m_generation; };
+        if(next == clock::time_point::max())
+          m_cv.wait(l, woken);
+        else
+          m_cv.wait_until(l, next, woken);
+      }
+    }
+
+    std::array<shard, shard_count> m_shards;
+
+    // Deadline the timer thread waits for, as a count of clock ticks.
+    std::atomic<clock::rep> m_next_wake{clock::time_point::max().time_since_epoch().count()};
+    uint64_t m_generation{};
+    bool m_running = true;
+    std::mutex m_timer_mutex;
+    std::condition_variable m_cv;
+    std::thread m_thread;
+};
+
+}
+}
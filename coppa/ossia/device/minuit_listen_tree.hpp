@@ -0,0 +1,287 @@
+#pragma once
+#include <coppa/string_view.hpp>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace coppa
+{
+namespace ossia
+{
+// True if the address has OSC wildcards ('*' and '?' are supported).
+inline bool is_address_pattern(string_view address)
+{
+  return address.find_first_of("*?") != string_view::npos;
+}
+
+// Matches a segment of an address ("fader12")
+// against a segment of a pattern ("fader*").
+inline bool match_segment(string_view pattern, string_view segment)
+{
+  const auto npos = string_view::npos;
+  std::size_t p = 0, s = 0;
+  std::size_t star = npos, mark = 0;
+  while(s < segment.size())
+  {
+    if(p < pattern.size() && (pattern[p] == '?' || pattern[p] == segment[s]))
+    {
+      p++;
+      s++;
+    }
+    else if(p < pattern.size() && pattern[p] == '*')
+    {
+      star = p++;
+      mark = s;
+    }
+    else if(star != npos)
+    {
+      // Let the last star match one more character.
+      p = star + 1;
+      s = ++mark;
+    }
+    else
+    {
+      return false;
+    }
+  }
+
+  while(p < pattern.size() && pattern[p] == '*')
+    p++;
+  return p == pattern.size();
+}
+
+/**
+ * @brief The minuit_listen_tree class
+ *
+ * Entries on address patterns ("/mixer/fader?/gai*") and on subtrees
+ * (everything under "/mixer"), stored once per pattern in a tree
+ * of address segments.
+ *
+ * An address is matched by walking down its segments : at each level
+ * only the child of the same name and the wildcard children are followed,
+ * so the cost depends on the depth of the address and not on the
+ * number of entries. The addresses created after an entry are
+ * matched like the other ones.
+ */
+template<typename T>
+class minuit_listen_tree
+{
+  public:
+    // The entry of a pattern, created if needed.
+    // A subtree entry also matches the addresses under the ones
+    // the pattern matches.
+    T& insert(string_view pattern, bool subtree)
+    {
+      node* n = &m_root;
+      for_each_segment(pattern, [&] (string_view segment) {
+        n = &n->child(segment);
+      });
+
+      auto& entry = subtree ? n->subtree : n->exact;
+      if(!entry)
+        entry = std::make_unique<T>();
+      return *entry;
+    }
+
+    T* find(string_view pattern, bool subtree)
+    {
+      return find_entry(pattern, subtree);
+    }
+
+    const T* find(string_view pattern, bool subtree) const
+    {
+      return find_entry(pattern, subtree);
+    }
+
+    // Calls f on each entry which matches the address.
+    template<typename F>
+    void match(string_view address, F&& f)
+    {
+      match(m_root, without_root(address), f);
+    }
+
+    template<typename F>
+    void for_each(F&& f)
+    {
+      for_each(m_root, f);
+    }
+
+    template<typename F>
+    void for_each(F&& f) const
+    {
+      auto as_const = [&] (const T& entry) { f(entry); };
+      for_each(m_root, as_const);
+    }
+
+    // Removes the entries for which f returns true,
+    // and the branches left without entries.
+    template<typename F>
+    void erase_if(F&& f)
+    {
+      erase_if(m_root, f);
+    }
+
+    bool empty() const
+    {
+      return m_root.empty();
+    }
+
+  private:
+    struct node
+    {
+        std::map<std::string, std::unique_ptr<node>, std::less<>> children;
+        std::vector<std::pair<std::string, std::unique_ptr<node>>> patterns;
+        std::unique_ptr<T> exact;
+        std::unique_ptr<T> subtree;
+
+        node& child(string_view segment)
+        {
+          if(is_address_pattern(segment))
+          {
+            for(auto& p : patterns)
+            {
+              if(p.first == segment)
+                return *p.second;
+            }
+            patterns.emplace_back(segment.to_string(), std::make_unique<node>());
+            return *patterns.back().second;
+          }
+
+          auto it = children.find(segment);
+          if(it == children.end())
+            it = children.emplace(segment.to_string(), std::make_unique<node>()).first;
+          return *it->second;
+        }
+
+        node* find_child(string_view segment) const
+        {
+          if(is_address_pattern(segment))
+          {
+            for(auto& p : patterns)
+            {
+              if(p.first == segment)
+                return p.second.get();
+            }
+            return nullptr;
+          }
+
+          auto it = children.find(segment);
+          return it != children.end() ? it->second.get() : nullptr;
+        }
+
+        bool empty() const
+        {
+          return !exact && !subtree && children.empty() && patterns.empty();
+        }
+    };
+
+    T* find_entry(string_view pattern, bool subtree) const
+    {
+      const node* n = &m_root;
+      for_each_segment(pattern, [&] (string_view segment) {
+        if(n)
+          n = n->find_child(segment);
+      });
+
+      if(!n)
+        return nullptr;
+      return (subtree ? n->subtree : n->exact).get();
+    }
+
+    static string_view without_root(string_view address)
+    {
+      if(!address.empty() && address[0] == '/')
+        address.remove_prefix(1);
+      return address;
+    }
+
+    template<typename F>
+    static void for_each_segment(string_view address, F&& f)
+    {
+      address = without_root(address);
+      while(!address.empty())
+      {
+        auto pos = address.find('/');
+        f(address.substr(0, pos));
+        if(pos == string_view::npos)
+          break;
+        address.remove_prefix(pos + 1);
+      }
+    }
+
+    template<typename F>
+    static void match(node& n, string_view rest, F& f)
+    {
+      // The subtree of a node includes the node itself.
+      if(n.subtree)
+        f(*n.subtree);
+
+      if(rest.empty())
+      {
+        if(n.exact)
+          f(*n.exact);
+        return;
+      }
+
+      auto pos = rest.find('/');
+      auto segment = rest.substr(0, pos);
+      auto next = pos == string_view::npos ? string_view{} : rest.substr(pos + 1);
+
+      auto it = n.children.find(segment);
+      if(it != n.children.end())
+        match(*it->second, next, f);
+
+      for(auto& p : n.patterns)
+      {
+        if(match_segment(p.first, segment))
+          match(*p.second, next, f);
+      }
+    }
+
+    template<typename F>
+    static void for_each(const node& n, F& f)
+    {
+      if(n.exact)
+        f(*n.exact);
+      if(n.subtree)
+        f(*n.subtree);
+      for(auto& c : n.children)
+        for_each(*c.second, f);
+      for(auto& p : n.patterns)
+        for_each(*p.second, f);
+    }
+
+    template<typename F>
+    static void erase_if(node& n, F& f)
+    {
+      if(n.exact && f(*n.exact))
+        n.exact.reset();
+      if(n.subtree && f(*n.subtree))
+        n.subtree.reset();
+
+      for(auto it = n.children.begin(); it != n.children.end(); )
+      {
+        erase_if(*it->second, f);
+        if(it->second->empty())
+          it = n.children.erase(it);
+        else
+          ++it;
+      }
+
+      for(auto it = n.patterns.begin(); it != n.patterns.end(); )
+      {
+        erase_if(*it->second, f);
+        if(it->second->empty())
+          it = n.patterns.erase(it);
+        else
+          ++it;
+      }
+    }
+
+    node m_root;
+};
+
+}
+}
@@ -1,86 +1,177 @@
 #pragma once
 #include <coppa/ossia/parameter.hpp>
+#include <coppa/ossia/bounding.hpp>
 #include <coppa/device/local.hpp>
 #include <coppa/ossia/device/message_handler.hpp>
 #include <coppa/ossia/device/minuit_local_behaviour.hpp>
+#include <coppa/ossia/device/minuit_listen_tree.hpp>
 #include <coppa/ossia/device/device_with_callbacks.hpp>
 #include <coppa/map.hpp>
 
 #include <coppa/protocol/osc/oscreceiver.hpp>
 #include <coppa/protocol/osc/oscsender.hpp>
+#include <coppa/protocol/osc/oscbundle.hpp>
 #include <coppa/protocol/osc/oscmessagegenerator.hpp>
 #include <coppa/string_view.hpp>
 #include <nano-signal-slot/nano_signal_slot.hpp>
+#include <algorithm>
 #include <array>
 #include <bitset>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 namespace coppa
 {
 namespace ossia
 {
 
-struct listened_attribute
+/**
+ * @brief The basic_minuit_client struct
+ *
+ * A client of a minuit_listening_local_device, e.g. a console.
+ * The listen replies to send to it are gathered in a bundle.
+ */
+template<typename Sender = coppa::osc::sender>
+struct basic_minuit_client
 {
-        listened_attribute() = default;
-        listened_attribute(const std::string& other):
-            path{other}
+        basic_minuit_client(const std::string& ip, int port):
+            sender{ip, port}
         {
 
         }
 
-        listened_attribute(string_view other):
-            path{other}
+        // The bundle is sent first if the message does not fit.
+        void queue(const oscpack::OutboundPacketStream& message, std::size_t max_packet_size)
         {
-
+            queue(message.Data(), message.Size(), max_packet_size);
         }
 
-        std::string path;
-
-        void enable(minuit_attribute a) const
-        {
-            attributes[static_cast<int>(a)] = true;
-        }
-        void disable(minuit_attribute a) const
+        void queue(const char* data, std::size_t size, std::size_t max_packet_size)
         {
-            attributes[static_cast<int>(a)] = false;
+            if(!pending.empty() && pending.size_with(size) > max_packet_size)
+                flush();
+            pending.add(data, size);
         }
 
-        bool empty() const
+        void flush()
         {
-            return attributes.none();
+            if(pending.empty())
+                return;
+
+            if(pending.count() == 1)
+            {
+                // No need for a bundle : "#bundle" + time tag + element size.
+                sender.send_raw(pending.data() + 20, pending.size() - 20);
+            }
+            else
+            {
+                sender.send_raw(pending.data(), pending.size());
+            }
+            pending.clear();
         }
 
-        mutable std::bitset<8> attributes;
+        Sender sender;
+        coppa::osc::bundle_writer pending;
+        std::chrono::steady_clock::time_point last_seen;
+        bool expired{};
+};
+using minuit_client = basic_minuit_client<>;
+
+// A client listening to attributes of a parameter.
+// If min_interval is set, the values are sent at most once per interval ;
+// a value that comes sooner is kept pending until flush_notifications().
+template<typename Client = minuit_client>
+struct basic_minuit_subscription
+{
+        std::shared_ptr<Client> client;
+        std::bitset<8> attributes;
+        std::chrono::steady_clock::duration min_interval{};
+        std::chrono::steady_clock::time_point last_sent{};
+        bool pending{};
 
-        friend
-        bool operator<(const std::string& other, const listened_attribute& attr)
+        bool too_soon(std::chrono::steady_clock::time_point now) const
         {
-            return attr.path < other;
+            return too_soon(min_interval, last_sent, now);
         }
 
-        friend
-        bool operator<(const listened_attribute& attr, const std::string& other)
+        static bool too_soon(
+                std::chrono::steady_clock::duration min_interval,
+                std::chrono::steady_clock::time_point last_sent,
+                std::chrono::steady_clock::time_point now)
         {
-            return attr.path < other;
+            return min_interval > min_interval.zero()
+                && last_sent != decltype(last_sent){}
+                && now - last_sent < min_interval;
         }
+};
+using minuit_subscription = basic_minuit_subscription<>;
+
+// The state of a parameter for a rate-limited pattern subscription.
+struct minuit_pattern_target
+{
+        std::chrono::steady_clock::time_point last_sent{};
+        Value last_value;
+        int32_t priority{};
+        bool pending{};
+};
 
-        friend
-        bool operator<(string_view other, const listened_attribute& attr)
+// A client listening to the parameters matching a pattern,
+// or to all the parameters under a container.
+// The rate limit applies to each parameter : the targets are only
+// kept if min_interval is set.
+template<typename Client = minuit_client>
+struct basic_minuit_pattern_subscription
+{
+        basic_minuit_subscription<Client> subscription;
+        std::map<std::string, minuit_pattern_target, std::less<>> targets;
+};
+using minuit_pattern_subscription = basic_minuit_pattern_subscription<>;
+
+// The subscribers of a parameter.
+template<typename Client = minuit_client>
+struct basic_minuit_listened_parameter
+{
+        // "/address:value", as sent in the listen replies.
+        std::string value_address;
+        std::vector<basic_minuit_subscription<Client>> subscribers;
+
+        // The last value, if a subscriber is pending.
+        Value last_value;
+        int32_t priority{};
+};
+using minuit_listened_parameter = basic_minuit_listened_parameter<>;
+
+// Sends the replies to the client whose request is being handled.
+template<typename Client = minuit_client>
+class basic_minuit_reply_sender
+{
+    public:
+        basic_minuit_reply_sender(const std::shared_ptr<Client>& current):
+            m_current{current}
         {
-            return attr.path < other;
+
         }
 
-        friend
-        bool operator<(const listened_attribute& attr, string_view other)
+        template<typename... Args>
+        void send(Args&&... args)
         {
-            return attr.path < other;
+            if(m_current)
+                m_current->sender.send(std::forward<Args>(args)...);
         }
 
-        friend
-        bool operator<(const listened_attribute& lhs, const listened_attribute& rhs)
+        void send_raw(const char* data, std::size_t size)
         {
-            return lhs.path < rhs.path;
+            if(m_current)
+                m_current->sender.send_raw(data, size);
         }
+
+    private:
+        const std::shared_ptr<Client>& m_current;
 };
+using minuit_reply_sender = basic_minuit_reply_sender<>;
 
 // The "local" behaviour only answers to requests.
 template<minuit_command Req, minuit_operation Op>
@@ -99,6 +190,8 @@ struct minuit_listening_local_behaviour<
         minuit_operation::Listen>
 {
 
+        // A request on a pattern ("/mixer/*") or on a container
+        // is stored once, and covers the parameters created afterwards.
         template<typename Device, typename Map>
         void handle_listening(
                 Device& dev,
@@ -107,32 +200,24 @@ struct minuit_listening_local_behaviour<
                 minuit_attribute attr,
                 bool enablement)
         {
-            auto listen_it = dev.client.listened.find(address);
-            if(listen_it != dev.client.listened.end())
+            if(is_address_pattern(address))
             {
-                if(enablement)
-                {
-                    listen_it->enable(attr);
-                }
-                else
-                {
-                    listen_it->disable(attr);
-                    if(listen_it->empty())
-                        dev.client.listened.erase(listen_it);
-                }
+                dev.listen_pattern(address, false, attr, enablement);
+                return;
             }
-            else
+
+            if(!enablement)
             {
-                if(enablement)
-                {
-                    auto it = map.find(address);
-                    if(it != map.end())
-                    {
-                        auto res_it = dev.client.listened.emplace(address);
-                        res_it.first->enable(attr);
-                    }
-                }
+                dev.listen(address, attr, false);
+                dev.listen_pattern(address, true, attr, false);
+                return;
             }
+
+            // The containers are not always nodes of the map.
+            if(has_children(map, address))
+                dev.listen_pattern(address, true, attr, true);
+            else if(map.find(address) != map.end())
+                dev.listen(address, attr, true);
         }
 
         template<typename Device, typename Map>
@@ -152,103 +237,645 @@ struct minuit_listening_local_behaviour<
             arg_it++;
             bool enablement = arg_it->AsString()[0] == 'e';
 
-            auto idx = full_address.find_first_of(":");
-
-            if(idx == std::string::npos)
-            {
-                handle_listening(dev, map, full_address, minuit_attribute::Value, enablement);
-            }
-            else
-            {
-                string_view address{full_address.data(), idx};
-
-                // Note : bug if address == "foo:"
-                auto attr = get_attribute(
-                                string_view(
-                                    address.data() + idx + 1,
-                                    full_address.size() - idx - 1));
-
+            string_view address;
+            minuit_attribute attr;
+            if(split_attribute(full_address, address, attr))
                 handle_listening(dev, map, address, attr, enablement);
-            }
         }
 };
 
 
-struct listener
-{
-        listener(const std::string& ip, int port):
-            sender{ip, port}
-        {
-
-        }
-
-        coppa::osc::sender sender;
-        std::set<listened_attribute, std::less<>> listened;
-};
-
-// This one supports a single listener
-class minuit_listening_local_device :
+/**
+ * @brief The basic_minuit_listening_local_device class
+ *
+ * A local Minuit device that sends the changes of the parameters
+ * to the clients listening to them.
+ *
+ * The clients are identified by the address their requests come from,
+ * and the replies go to this address, on reply_port
+ * (or on the port of the requests if reply_port is 0).
+ * A client that sent nothing for client_timeout is forgotten,
+ * with its subscriptions.
+ *
+ * The subscribers of each parameter are indexed by address,
+ * so that update() only looks at the clients listening to it.
+ * The requests on patterns and containers are kept in a minuit_listen_tree ;
+ * a client that matches several times is sent each value once.
+ *
+ * The listen replies of the updates made between begin_batch() and
+ * end_batch() are sent together, in as few bundles per client as possible,
+ * by decreasing Priority of their parameter : when a batch does not fit
+ * in one packet, the transport and the cues go before the meters.
+ * The replies can also be rate-limited per subscription,
+ * see set_listen_interval. The replies held back by the rate limit are
+ * not sent by the device itself : the application has to call
+ * flush_notifications() regularly, e.g. at each tick of its main loop.
+ *
+ * Sender is used to send the replies to each client.
+ */
+template<typename Sender = coppa::osc::sender>
+class basic_minuit_listening_local_device :
         public coppa::ossia::device_with_callbacks
 {
     public:
         using map_type = coppa::locked_map<coppa::basic_map<ParameterMapType<coppa::ossia::Parameter>>>;
-        using parent_t = minuit_listening_local_device;
+        using parent_t = basic_minuit_listening_local_device;
+        using clock = std::chrono::steady_clock;
+        using client_type = basic_minuit_client<Sender>;
+
+    private:
+        using subscription_type = basic_minuit_subscription<client_type>;
+        using pattern_subscription_type = basic_minuit_pattern_subscription<client_type>;
+        using listened_parameter_type = basic_minuit_listened_parameter<client_type>;
 
-        minuit_listening_local_device(
+    public:
+        basic_minuit_listening_local_device(
                 map_type& map,
                 std::string name,
                 unsigned int in_port,
-                std::string out_ip,
-                unsigned int out_port):
+                unsigned int reply_port = 0):
             m_map{map},
             m_server{in_port, [&] (const auto& m, const auto& ip)
         {
-            coppa::ossia::minuit_message_handler<minuit_listening_local_behaviour>::on_messageReceived(*this, m_map, m, ip);
+            this->handle(m, ip);
         }},
-            client{out_ip, int(out_port)},
+            m_reply_port{reply_port},
             nameTable{name}
         {
             m_server.run();
         }
 
+        // The receive thread uses the clients and the subscriptions,
+        // which are declared after the server : it is stopped first.
+        ~basic_minuit_listening_local_device()
+        {
+            m_server.stop();
+        }
+
         auto name() const
         { return nameTable.get_device_name(); }
 
         auto& map() const
         { return m_map; }
 
+        // Called for each message received.
+        void handle(const oscpack::ReceivedMessage& m, const oscpack::IpEndpointName& ip)
+        {
+            const auto now = clock::now();
+            m_current = find_client(ip, now);
+            coppa::ossia::minuit_message_handler<minuit_listening_local_behaviour>::on_messageReceived(*this, m_map, m, ip);
+            m_current.reset();
+
+            if(now >= m_next_expiry)
+            {
+                expire_clients(now);
+                m_next_expiry = now + std::chrono::seconds(1);
+            }
+        }
+
+        // (Un)subscribes the client whose request is being handled.
+        void listen(string_view address, minuit_attribute attr, bool enablement)
+        {
+            if(!m_current)
+                return;
+
+            std::lock_guard<std::mutex> lock{m_clients_mutex};
+            if(m_current->expired)
+                return;
+
+            auto it = m_subscriptions.find(address);
+            if(it == m_subscriptions.end())
+            {
+                if(!enablement)
+                    return;
+
+                listened_parameter_type param;
+                param.value_address = value_address(address);
+                it = m_subscriptions.emplace(std::string(address.data(), address.size()), std::move(param)).first;
+            }
+
+            subscribe(it->second.subscribers, attr, enablement);
+            if(it->second.subscribers.empty())
+                m_subscriptions.erase(it);
+        }
+
+        // (Un)subscribes the client whose request is being handled
+        // to the parameters matching a pattern, or to all the parameters
+        // under an address if subtree is set.
+        void listen_pattern(string_view pattern, bool subtree, minuit_attribute attr, bool enablement)
+        {
+            if(!m_current)
+                return;
+
+            std::lock_guard<std::mutex> lock{m_clients_mutex};
+            if(m_current->expired)
+                return;
+
+            if(enablement)
+            {
+                subscribe(m_patterns.insert(pattern, subtree), attr, true);
+            }
+            else if(auto subscribers = m_patterns.find(pattern, subtree))
+            {
+                subscribe(*subscribers, attr, false);
+                if(subscribers->empty())
+                    m_patterns.erase_if([] (const auto& subs) { return subs.empty(); });
+            }
+        }
+
+        void set_client_timeout(clock::duration t)
+        { m_client_timeout = t; }
+        clock::duration client_timeout() const
+        { return m_client_timeout; }
+
+        // Forgets the clients that sent nothing since now - client_timeout.
+        void expire_clients(clock::time_point now = clock::now())
+        {
+            std::lock_guard<std::mutex> lock{m_clients_mutex};
+            bool expired = false;
+            for(auto it = m_clients.begin(); it != m_clients.end(); )
+            {
+                if(now - it->second->last_seen > m_client_timeout)
+                {
+                    it->second->expired = true;
+                    it = m_clients.erase(it);
+                    expired = true;
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+
+            if(!expired)
+                return;
+
+            for(auto it = m_subscriptions.begin(); it != m_subscriptions.end(); )
+            {
+                auto& subscribers = it->second.subscribers;
+                subscribers.erase(
+                            std::remove_if(subscribers.begin(), subscribers.end(),
+                                           [] (const auto& s) { return s.client->expired; }),
+                            subscribers.end());
+
+                if(subscribers.empty())
+                    it = m_subscriptions.erase(it);
+                else
+                    ++it;
+            }
+
+            m_patterns.erase_if([] (auto& subscribers) {
+                subscribers.erase(
+                            std::remove_if(subscribers.begin(), subscribers.end(),
+                                           [] (const auto& s) { return s.subscription.client->expired; }),
+                            subscribers.end());
+                return subscribers.empty();
+            });
+        }
+
+        std::size_t client_count() const
+        {
+            std::lock_guard<std::mutex> lock{m_clients_mutex};
+            return m_clients.size();
+        }
+
+        // Clients listening to this exact address.
+        std::size_t subscriber_count(string_view address) const
+        {
+            std::lock_guard<std::mutex> lock{m_clients_mutex};
+            auto it = m_subscriptions.find(address);
+            return it != m_subscriptions.end() ? it->second.subscribers.size() : 0;
+        }
+
+        // Clients listening to a pattern, or to the subtree of an address.
+        std::size_t pattern_subscriber_count(string_view pattern, bool subtree) const
+        {
+            std::lock_guard<std::mutex> lock{m_clients_mutex};
+            auto subscribers = m_patterns.find(pattern, subtree);
+            return subscribers ? subscribers->size() : 0;
+        }
+
+        // Minimal interval between two listen replies to a client,
+        // for the new subscriptions.
+        void set_listen_interval(clock::duration t)
+        {
+            std::lock_guard<std::mutex> lock{m_clients_mutex};
+            m_listen_interval = t;
+        }
+
+        // Same, for the current subscriptions to an address.
+        void set_listen_interval(string_view address, clock::duration t)
+        {
+            std::lock_guard<std::mutex> lock{m_clients_mutex};
+            auto it = m_subscriptions.find(address);
+            if(it != m_subscriptions.end())
+            {
+                for(auto& sub : it->second.subscribers)
+                    sub.min_interval = t;
+            }
+
+            for(bool subtree : {false, true})
+            {
+                if(auto subscribers = m_patterns.find(address, subtree))
+                {
+                    for(auto& sub : *subscribers)
+                        sub.subscription.min_interval = t;
+                }
+            }
+        }
+
+        void begin_batch()
+        {
+            std::lock_guard<std::mutex> lock{m_clients_mutex};
+            m_batch_depth++;
+        }
+
+        // Sends the listen replies gathered since begin_batch().
+        void end_batch()
+        {
+            std::lock_guard<std::mutex> lock{m_clients_mutex};
+            if(m_batch_depth > 0 && --m_batch_depth == 0)
+                flush_clients();
+        }
+
+        // Sends the rate-limited replies that are due.
+        // To be called regularly, e.g. at each tick : else they stay pending.
+        void flush_notifications(clock::time_point now = clock::now())
+        {
+            std::lock_guard<std::mutex> lock{m_clients_mutex};
+
+            // Sent by priority, like a batch.
+            m_batch_depth++;
+            for(auto& elt : m_subscriptions)
+            {
+                auto& param = elt.second;
+                bool serialized = false;
+                for(auto& sub : param.subscribers)
+                {
+                    if(!sub.pending || sub.too_soon(now))
+                        continue;
+
+                    if(!serialized)
+                    {
+                        m_generator(nameTable.get_action(minuit_action::ListenReply),
+                                    string_view(param.value_address),
+                                    param.last_value);
+                        serialized = true;
+                    }
+                    notify(sub.client, param.priority);
+                    sub.last_sent = now;
+                    sub.pending = false;
+                }
+            }
+
+            m_patterns.for_each([&] (auto& subscribers) {
+                for(auto& sub : subscribers)
+                {
+                    for(auto& target : sub.targets)
+                    {
+                        auto& t = target.second;
+                        if(!t.pending || subscription_type::too_soon(sub.subscription.min_interval, t.last_sent, now))
+                            continue;
+
+                        m_generator(nameTable.get_action(minuit_action::ListenReply),
+                                    string_view(value_address(target.first)),
+                                    t.last_value);
+                        notify(sub.subscription.client, t.priority);
+                        t.last_sent = now;
+                        t.pending = false;
+                    }
+                }
+            });
+
+            if(--m_batch_depth == 0)
+                flush_clients();
+        }
+
+        // Number of rate-limited replies waiting for flush_notifications().
+        std::size_t pending_notifications() const
+        {
+            std::lock_guard<std::mutex> lock{m_clients_mutex};
+            std::size_t n = 0;
+            for(const auto& elt : m_subscriptions)
+            {
+                for(const auto& sub : elt.second.subscribers)
+                    n += sub.pending;
+            }
+
+            m_patterns.for_each([&] (const auto& subscribers) {
+                for(const auto& sub : subscribers)
+                {
+                    for(const auto& target : sub.targets)
+                        n += target.second.pending;
+                }
+            });
+            return n;
+        }
+
+        // The value is bounded according to the range of the parameter.
+        // If the parameter filters repetitions, nothing is notified
+        // nor sent when the value does not change.
         template<typename String, typename Arg>
         void update(param_t<String> path, Arg&& val)
         {
-            auto map_it = m_map.update(path, std::forward<Arg>(val));
-            if(map_it != m_map.end())
+            update_and_notify(string_view{path}, [&] (auto& p) {
+                if(!p.repetitionFilter)
+                {
+                    val(p);
+                    apply_bounding(p);
+                    return true;
+                }
+
+                const Value previous = p;
+                val(p);
+                apply_bounding(p);
+                return !same_value(previous.value, p.value);
+            });
+        }
+
+        // A plain OSC message was received for a parameter :
+        // it is applied and notified like an update().
+        // Called by convert_osc_handler.
+        void receive_osc(string_view address, const oscpack::ReceivedMessage& m)
+        {
+            bool changed = update_and_notify(address, [&] (auto& p) {
+                return update_value(m, p);
+            });
+
+            if(changed)
             {
-                auto res = *map_it;
-                on_value_changed(res);
+                if(auto callback = find_view_callback(address.to_string()))
+                    (*callback)(value_view{address, m});
+            }
+        }
 
-                auto it = client.listened.find(path);
-                if(it != client.listened.end())
+    private:
+        // Applies the updater, which returns false if the value
+        // did not change, then notifies the application and the clients
+        // listening to the address.
+        template<typename Updater>
+        bool update_and_notify(string_view address, Updater&& updater)
+        {
+            bool changed = true;
+            Parameter res;
+            {
+                auto l = m_map.acquire_write_lock();
+                auto& data_map = m_map.get_data_map();
+                auto node_it = data_map.find_cached(address);
+                if(node_it == data_map.end())
+                    return false;
+
+                data_map.update_in_place(node_it, [&] (auto& p) {
+                    changed = updater(p);
+                });
+                if(!changed)
+                    return false;
+                res = *node_it;
+            }
+
+            on_value_changed(res);
+
+            std::lock_guard<std::mutex> lock{m_clients_mutex};
+            auto it = m_subscriptions.find(address);
+            if(it == m_subscriptions.end() && m_patterns.empty())
+                return true;
+
+            // A:listen /WhereToListen:attribute value (each time the attribute change if the listening is turned on)
+            // The message is the same for all the clients.
+            const auto& value = static_cast<const Value&>(res);
+            const auto now = clock::now();
+            bool serialized = false;
+            std::string pattern_value_address;
+            auto serialize = [&] {
+                if(serialized)
+                    return;
+
+                string_view reply_address;
+                if(it != m_subscriptions.end())
+                {
+                    reply_address = it->second.value_address;
+                }
+                else
                 {
-                    // A:listen /WhereToListen:attribute value (each time the attribute change if the listening is turned on)
-                    std::string final_path = path.to_string() + ":" + to_minuit_attribute_text(minuit_attribute::Value).to_string();
-                    client.sender.send(
-                                nameTable.get_action(minuit_action::ListenReply),
-                                string_view(final_path),
-                                static_cast<const Value&>(res));
+                    pattern_value_address = value_address(address);
+                    reply_address = pattern_value_address;
                 }
 
+                m_generator(nameTable.get_action(minuit_action::ListenReply),
+                            reply_address,
+                            value);
+                serialized = true;
+            };
+
+            m_notified.clear();
+            if(it != m_subscriptions.end())
+            {
+                auto& param = it->second;
+                for(auto& sub : param.subscribers)
+                {
+                    if(!sub.attributes[static_cast<int>(minuit_attribute::Value)])
+                        continue;
+
+                    m_notified.push_back(sub.client.get());
+                    if(sub.too_soon(now))
+                    {
+                        sub.pending = true;
+                        param.last_value = value;
+                        param.priority = res.priority;
+                        continue;
+                    }
+
+                    serialize();
+                    notify(sub.client, res.priority);
+                    sub.last_sent = now;
+                    sub.pending = false;
+                }
             }
+
+            m_patterns.match(address, [&] (auto& subscribers) {
+                for(auto& pattern_sub : subscribers)
+                {
+                    auto& sub = pattern_sub.subscription;
+                    if(!sub.attributes[static_cast<int>(minuit_attribute::Value)])
+                        continue;
+
+                    // Already notified through another subscription.
+                    auto client = sub.client.get();
+                    if(std::find(m_notified.begin(), m_notified.end(), client) != m_notified.end())
+                        continue;
+                    m_notified.push_back(client);
+
+                    if(sub.min_interval > sub.min_interval.zero())
+                    {
+                        auto target = pattern_sub.targets.find(address);
+                        if(target == pattern_sub.targets.end())
+                            target = pattern_sub.targets.emplace(address.to_string(), minuit_pattern_target{}).first;
+
+                        auto& t = target->second;
+                        if(subscription_type::too_soon(sub.min_interval, t.last_sent, now))
+                        {
+                            t.pending = true;
+                            t.last_value = value;
+                            t.priority = res.priority;
+                            continue;
+                        }
+                        t.last_sent = now;
+                        t.pending = false;
+                    }
+
+                    serialize();
+                    notify(sub.client, res.priority);
+                }
+            });
+
+            if(m_batch_depth == 0)
+                flush_clients();
+            return true;
+        }
+
+        // "/address:value", as sent in the listen replies.
+        static std::string value_address(string_view address)
+        {
+            std::string str;
+            str.reserve(address.size() + 6);
+            str.append(address.data(), address.size());
+            str += ':';
+            str += to_minuit_attribute_text(minuit_attribute::Value).to_string();
+            return str;
+        }
+
+        // Requires the lock on the clients.
+        // Sets the attribute of the subscription of the current client.
+        template<typename Subscriptions>
+        void subscribe(Subscriptions& subscribers, minuit_attribute attr, bool enablement)
+        {
+            auto sub = std::find_if(subscribers.begin(), subscribers.end(),
+                                    [&] (auto& s) { return subscription_of(s).client == m_current; });
+            if(sub == subscribers.end())
+            {
+                if(!enablement)
+                    return;
+                subscribers.emplace_back();
+                sub = subscribers.end() - 1;
+                subscription_of(*sub).client = m_current;
+                subscription_of(*sub).min_interval = m_listen_interval;
+            }
+
+            auto& attributes = subscription_of(*sub).attributes;
+            attributes[static_cast<int>(attr)] = enablement;
+            if(attributes.none())
+                subscribers.erase(sub);
+        }
+
+        static subscription_type& subscription_of(subscription_type& s)
+        { return s; }
+        static subscription_type& subscription_of(pattern_subscription_type& s)
+        { return s.subscription; }
+
+        // Requires the lock on the clients.
+        // Outside of a batch the reply in the generator is queued
+        // right away ; in a batch it is kept until flush_clients().
+        void notify(const std::shared_ptr<client_type>& client, int32_t priority)
+        {
+            const auto& message = m_generator.stream();
+            if(m_batch_depth == 0)
+            {
+                client->queue(message, m_max_packet_size);
+                return;
+            }
+
+            if(m_staged_count == m_staged.size())
+                m_staged.emplace_back();
+            auto& staged = m_staged[m_staged_count++];
+            staged.priority = priority;
+            staged.client = client;
+            staged.message.assign(message.Data(), message.Size());
+        }
+
+        // Requires the lock on the clients.
+        // The staged replies are queued by decreasing priority,
+        // in their order for a same priority.
+        void flush_clients()
+        {
+            if(m_staged_count > 0)
+            {
+                m_order.resize(m_staged_count);
+                for(std::size_t i = 0; i < m_staged_count; i++)
+                    m_order[i] = i;
+                std::stable_sort(m_order.begin(), m_order.end(), [&] (std::size_t lhs, std::size_t rhs) {
+                    return m_staged[lhs].priority > m_staged[rhs].priority;
+                });
+
+                for(auto i : m_order)
+                {
+                    auto& staged = m_staged[i];
+                    staged.client->queue(staged.message.data(), staged.message.size(), m_max_packet_size);
+                    staged.client.reset();
+                }
+                m_staged_count = 0;
+            }
+
+            for(auto& client : m_clients)
+                client.second->flush();
+        }
+
+        std::shared_ptr<client_type> find_client(
+                const oscpack::IpEndpointName& ip,
+                clock::time_point now)
+        {
+            const int port = m_reply_port != 0 ? int(m_reply_port) : ip.port;
+            const uint64_t key = (uint64_t(ip.address) << 32) | uint32_t(port);
+
+            std::lock_guard<std::mutex> lock{m_clients_mutex};
+            auto& client = m_clients[key];
+            if(!client)
+            {
+                const auto a = ip.address;
+                const std::string address =
+                        std::to_string((a >> 24) & 0xFF) + "." + std::to_string((a >> 16) & 0xFF) + "."
+                      + std::to_string((a >> 8) & 0xFF) + "." + std::to_string(a & 0xFF);
+                client = std::make_shared<client_type>(address, port);
+            }
+            client->last_seen = now;
+            return client;
         }
 
-    private:
         map_type& m_map;
         coppa::osc::receiver m_server;
+        unsigned int m_reply_port{};
+
+        mutable std::mutex m_clients_mutex;
+        std::unordered_map<uint64_t, std::shared_ptr<client_type>> m_clients;
+        std::map<std::string, listened_parameter_type, std::less<>> m_subscriptions;
+        minuit_listen_tree<std::vector<pattern_subscription_type>> m_patterns;
+        std::vector<const client_type*> m_notified; // During update()
+        clock::duration m_client_timeout{std::chrono::minutes(10)};
+        clock::time_point m_next_expiry{};
+
+        clock::duration m_listen_interval{};
+        int m_batch_depth{};
+
+        // The replies of the current batch ; the storage is reused.
+        struct staged_reply
+        {
+                int32_t priority{};
+                std::shared_ptr<client_type> client;
+                std::string message;
+        };
+        std::vector<staged_reply> m_staged;
+        std::size_t m_staged_count{};
+        std::vector<std::size_t> m_order;
+        std::size_t m_max_packet_size{1472}; // Fits in an Ethernet frame
+        oscpack::MessageGenerator<> m_generator;
+
+        // The client whose request is being handled, in the receive thread.
+        std::shared_ptr<client_type> m_current;
 
     public:
-        listener client;
-        coppa::osc::sender& sender = client.sender;
+        basic_minuit_reply_sender<client_type> sender{m_current};
         minuit_name_table nameTable;
 
 };
+using minuit_listening_local_device = basic_minuit_listening_local_device<>;
 }
 }
@@ -4,6 +4,12 @@
 #include <oscpack/osc/OscReceivedElements.h>
 #include <coppa/ossia/device/minuit_name_table.hpp>
 #include <coppa/ossia/parameter_ostream.hpp>
+#include <coppa/ossia/osc/osc.hpp>
+#include <coppa/map.hpp>
+#include <oscpack/osc/OscOutboundPacketStream.h>
+#include <coppa/protocol/osc/oscmessagegenerator.hpp>
+#include <boost/algorithm/string/predicate.hpp>
+#include <vector>
 namespace coppa
 {
 namespace ossia
@@ -46,13 +52,10 @@ struct minuit_local_behaviour<
       }
       else
       {
-        string_view address{full_address.data(), idx};
-
-        // Note : bug if address == "foo:"
-        auto attr = get_attribute(
-                      string_view(
-                        address.data() + idx + 1,
-                        full_address.size() - idx - 1));
+        string_view address;
+        minuit_attribute attr;
+        if(!split_attribute(full_address, address, attr))
+          return;
 
         auto it = map.find(address);
         if(it != map.end())
@@ -96,6 +99,11 @@ struct minuit_local_behaviour<
                               );
               break;
             case minuit_attribute::Priority:
+              dev.sender.send(dev.nameTable.get_action(minuit_action::GetReply),
+                              full_address,
+                              it->priority
+                              );
+              break;
             case minuit_attribute::Description:
             default:
               break;
@@ -127,56 +135,75 @@ struct minuit_local_behaviour<
     minuit_command::Request,
     minuit_operation::Namespace>
 {
-    template<typename Device, typename Children>
+    // The reply is kept in the cache of the map,
+    // see minuit_message_handler::cached_namespace_reply.
+    // Only the replies for existing nodes are kept, so that requests
+    // for arbitrary addresses cannot grow the cache.
+    template<typename Device, typename Map, typename... Args>
+    void reply(
+        Device& dev,
+        Map& map,
+        string_view address,
+        bool cached,
+        const Args&... args)
+    {
+      oscpack::MessageGenerator<> gen;
+      const auto& m = gen(dev.nameTable.get_action(minuit_action::NamespaceReply), address, args...);
+      if(cached)
+        map.namespace_replies().store(address, std::string(m.Data(), m.Size()));
+      dev.sender.send_raw(m.Data(), m.Size());
+    }
+
+    template<typename Device, typename Map, typename Children>
     void handle_root(
         Device& dev,
+        Map& map,
         Children&& c)
     {
-      dev.sender.send(dev.nameTable.get_action(minuit_action::NamespaceReply),
-                      "/",
-                      "Application",
-                      "nodes={",
-                               c,
-                            "}",
-                      "attributes={",
-                                 "}");
+      reply(dev, map, "/", true,
+            "Application",
+            "nodes={",
+                     c,
+                  "}",
+            "attributes={",
+                       "}");
 
     }
 
-    template<typename Device, typename Children>
+    template<typename Device, typename Map, typename Children>
     void handle_container(
         Device& dev,
+        Map& map,
         string_view address,
         Children&& c)
     {
-      dev.sender.send(dev.nameTable.get_action(minuit_action::NamespaceReply),
-                      address,
-                      "Container",
-                      "nodes={",
-                               c,
-                            "}",
-                      "attributes={",
-                                 "}");
+      reply(dev, map, address, true,
+            "Container",
+            "nodes={",
+                     c,
+                  "}",
+            "attributes={",
+                       "}");
 
     }
 
-    template<typename Device>
+    template<typename Device, typename Map>
     void handle_data(
         Device& dev,
+        Map& map,
         string_view address)
     {
-      dev.sender.send(dev.nameTable.get_action(minuit_action::NamespaceReply),
-                      address,
-                      "Data",
-                      "attributes={",
-                          "type"             ,
-                          "repetitionsFilter",
-                          "service"          ,
-                          "priority"         ,
-                          "value"            ,
-                          "rangeBounds"      ,
-                          "rangeClipmode"    ,
-                      "}");
+      reply(dev, map, address, map.find(address) != map.end(),
+            "Data",
+            "attributes={",
+                "type"             ,
+                "repetitionsFilter",
+                "service"          ,
+                "priority"         ,
+                "value"            ,
+                "rangeBounds"      ,
+                "rangeClipmode"    ,
+            "}");
 
     }
 
@@ -189,18 +216,132 @@ struct minuit_local_behaviour<
       string_view address{mess.ArgumentsBegin()->AsString()};
       if(isRoot(address))
       {
-        handle_root(dev, get_children_names(map, address));
+        handle_root(dev, map, get_children_names(map, address));
       }
       else
       {
         auto cld = get_children_names(map, address);
         if(!cld.empty())
         {
-          handle_container(dev, address, cld);
+          handle_container(dev, map, address, cld);
         }
         else
         {
-          handle_data(dev, address);
+          handle_data(dev, map, address);
+        }
+      }
+    }
+};
+
+// Dump (extension, see minuit_name_table::set_dump_extension)
+// Request : name?dump /address
+// Answer : name:dump /address total, then for each parameter under the address :
+//   address type service clipMode repetitionFilter priority
+//   value_count value... min_count min... max_count max...
+// The parameters are split in as many messages as needed ; each one starts
+// with the requested address and the total number of parameters.
+// If a parameter does not fit alone in a datagram, the answer ends with
+// name!dump /address, so that the requester falls back to namespace requests.
+template<>
+struct minuit_local_behaviour<
+    minuit_command::Request,
+    minuit_operation::Dump>
+{
+    // A message is closed once it is bigger than this.
+    static const constexpr std::size_t message_size = 1024;
+    // The biggest UDP datagram.
+    static const constexpr std::size_t max_message_size = 65507;
+
+    static bool in_subtree(string_view root, const std::string& address)
+    {
+      if(isRoot(root))
+        return true;
+      return boost::starts_with(address, root)
+          && (address.size() == root.size() || address[root.size()] == '/');
+    }
+
+    template<typename Parameter_T>
+    static void write_parameter(
+        oscpack::OutboundPacketStream& s,
+        const Parameter_T& p)
+    {
+      s << string_view(p.destination)
+        << to_minuit_type_text(p)
+        << to_minuit_service_text(p.access)
+        << to_minuit_bounding_text(p.bounding)
+        << int32_t(p.repetitionFilter)
+        << p.priority
+        << int32_t(argument_count(p.value)) << p.value
+        << int32_t(argument_count(p.min)) << p.min
+        << int32_t(argument_count(p.max)) << p.max;
+    }
+
+    template<typename Device, typename Map>
+    auto operator()(
+        Device& dev,
+        Map& map,
+        const oscpack::ReceivedMessage& mess)
+    {
+      string_view root{mess.ArgumentsBegin()->AsString()};
+
+      std::vector<decltype(&*map.begin())> params;
+      if(dev.nameTable.dump_extension())
+      {
+        for(const auto& p : map)
+        {
+          if(in_subtree(root, p.destination))
+            params.push_back(&p);
+        }
+      }
+
+      if(params.empty())
+      {
+        dev.sender.send(dev.nameTable.get_action(minuit_action::DumpError), root);
+        return;
+      }
+
+      const auto reply = dev.nameTable.get_action(minuit_action::DumpReply);
+      std::vector<char> buffer(4 * message_size);
+      std::size_t split = params.size(); // A message ends before this parameter.
+      for(std::size_t i = 0; i < params.size(); )
+      {
+        const auto first = i;
+        auto last = i;
+        try
+        {
+          oscpack::OutboundPacketStream s{buffer.data(), buffer.size()};
+          s << oscpack::BeginMessageN(reply) << root << int32_t(params.size());
+          do
+          {
+            last = i;
+            write_parameter(s, *params[i]);
+            ++i;
+          } while(i < params.size() && i != split && s.Size() < message_size);
+          s << oscpack::EndMessage();
+
+          dev.sender.send_raw(s.Data(), s.Size());
+        }
+        catch(const oscpack::OutOfBufferMemoryException&)
+        {
+          if(buffer.size() < max_message_size)
+          {
+            // A big value : retry with a bigger buffer.
+            auto size = 2 * buffer.size();
+            if(size > max_message_size)
+              size = max_message_size;
+            buffer.resize(size);
+          }
+          else if(last != first)
+          {
+            // The last parameter may fit in a message of its own.
+            split = last;
+          }
+          else
+          {
+            dev.sender.send(dev.nameTable.get_action(minuit_action::DumpError), root);
+            return;
+          }
+          i = first;
         }
       }
     }
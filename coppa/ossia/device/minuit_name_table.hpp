@@ -33,14 +33,36 @@ class minuit_name_table
       m_actions[(int)minuit_action::ListenRequest] = m_name + "?listen";
       m_actions[(int)minuit_action::ListenReply]   = m_name + ":listen";
       m_actions[(int)minuit_action::ListenError]   = m_name + "!listen";
+
+      m_actions[(int)minuit_action::DumpRequest] = m_name + "?dump";
+      m_actions[(int)minuit_action::DumpReply]   = m_name + ":dump";
+      m_actions[(int)minuit_action::DumpError]   = m_name + "!dump";
     }
 
     string_view get_action(minuit_action c)
     { return m_actions[static_cast<int>(c)]; }
 
+    /**
+     * Enables the subtree dump extension : "name?dump /address"
+     * is answered with all the parameters under the address, attributes
+     * included, in a few messages instead of one namespace request per node
+     * and one get request per attribute.
+     *
+     * A local device with the extension disabled answers "name!dump" ;
+     * a remote device with the extension enabled tries it first,
+     * and falls back to the standard namespace requests upon an error
+     * or a timeout.
+     */
+    void set_dump_extension(bool b)
+    { m_dump = b; }
+
+    bool dump_extension() const
+    { return m_dump; }
+
   private:
     std::string m_name;
-    std::array<std::string, 9> m_actions;
+    std::array<std::string, 12> m_actions;
+    bool m_dump{};
 };
 }
 }
@@ -0,0 +1,411 @@
+#pragma once
+#include <coppa/string_view.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+
+namespace coppa
+{
+namespace ossia
+{
+enum class minuit_crawl_request
+{
+  Namespace, // name?namespace /address
+  Get,       // name?get /address:attribute
+  Dump       // name?dump /address (extension)
+};
+
+struct minuit_crawl_progress
+{
+    std::size_t sent{};      // Distinct requests sent
+    std::size_t answered{};
+    std::size_t retried{};   // Retransmissions
+    std::size_t failed{};    // Requests given up after the last retry
+    std::size_t in_flight{};
+    std::size_t queued{};
+    std::size_t window{};    // Current in-flight window
+    std::size_t dumped{};    // Parameters received in dumps
+    std::size_t fallbacks{}; // Dumps replaced by namespace requests
+};
+
+/**
+ * @brief The minuit_namespace_crawler class
+ *
+ * Discovers the namespace of a remote Minuit device without flooding it.
+ * The requests are queued, and at most `window` of them are in flight:
+ * a new one is sent each time an answer comes.
+ * The namespace and dump requests go first, so that the tree is known before
+ * the attributes of its leaves are requested.
+ *
+ * A request without answer after the timeout is sent again, up to
+ * max_retries times, then given up. The window is halved upon a timeout
+ * and grows back by one for each answer, up to its configured size,
+ * so that the rate follows what the link and the remote can handle.
+ *
+ * A dump request may be answered in several messages : it is complete
+ * once all the parameters it announces were received. A dump that fails
+ * is replaced by a namespace request for the same address.
+ *
+ * A thread waits for the timeouts while a crawl is running.
+ * The callbacks are called without the lock held, from the thread that
+ * received the answer or from the timeout thread ; the send function is
+ * called with the lock held and must not call back into the crawler.
+ */
+class minuit_namespace_crawler
+{
+  public:
+    using clock = std::chrono::steady_clock;
+    using send_fun = std::function<void(minuit_crawl_request, string_view)>;
+    using progress_fun = std::function<void(const minuit_crawl_progress&)>;
+    using finished_fun = std::function<void(const minuit_crawl_progress&)>;
+
+    minuit_namespace_crawler(send_fun f):
+      m_send{std::move(f)}
+    {
+    }
+
+    ~minuit_namespace_crawler()
+    {
+      {
+        std::lock_guard<std::mutex> l{m_mutex};
+        m_running = false;
+      }
+      m_cv.notify_one();
+      if(m_thread.joinable())
+        m_thread.join();
+    }
+
+    void set_window(std::size_t n)
+    {
+      std::lock_guard<std::mutex> l{m_mutex};
+      m_max_window = std::max<std::size_t>(n, 1);
+      m_window = std::min(m_window, m_max_window);
+    }
+
+    void set_timeout(clock::duration t)
+    {
+      std::lock_guard<std::mutex> l{m_mutex};
+      m_timeout = t;
+    }
+
+    void set_max_retries(int n)
+    {
+      std::lock_guard<std::mutex> l{m_mutex};
+      m_max_retries = n;
+    }
+
+    void on_progress(progress_fun f)
+    {
+      std::lock_guard<std::mutex> l{m_mutex};
+      m_on_progress = std::move(f);
+    }
+
+    // Called once per crawl, even if some requests failed.
+    void on_finished(finished_fun f)
+    {
+      std::lock_guard<std::mutex> l{m_mutex};
+      m_on_finished = std::move(f);
+    }
+
+    // Starts a crawl from root ; does nothing if one is running.
+    // Returns false in this case.
+    bool start(
+        string_view root,
+        minuit_crawl_request kind = minuit_crawl_request::Namespace)
+    {
+      bool started = false;
+      locked([&] {
+        if(m_active)
+          return;
+
+        m_active = true;
+        m_progress = minuit_crawl_progress{};
+        m_window = m_max_window;
+        m_requested.clear();
+        push(kind, root);
+        started = true;
+
+        if(!m_thread.joinable())
+          m_thread = std::thread([this] { run(); });
+      });
+      return started;
+    }
+
+    // Queues a request, if it was not already made during this crawl.
+    void request(minuit_crawl_request kind, string_view address)
+    {
+      locked([&] {
+        if(m_active)
+          push(kind, address);
+      });
+    }
+
+    // An answer was received ; answers to requests
+    // which are not in flight are ignored.
+    void answered(string_view address)
+    {
+      locked([&] {
+        auto it = m_in_flight.find(address);
+        if(it == m_in_flight.end())
+          return;
+
+        m_in_flight.erase(it);
+        m_progress.answered++;
+        if(m_window < m_max_window)
+          m_window++;
+      });
+    }
+
+    // A message of the answer to a dump, with count of its total parameters.
+    void dump_received(string_view address, std::size_t count, std::size_t total)
+    {
+      locked([&] {
+        auto it = m_in_flight.find(address);
+        if(it == m_in_flight.end() || it->second.kind != minuit_crawl_request::Dump)
+          return;
+
+        auto& req = it->second;
+        req.received += count;
+        req.sent_at = clock::now(); // The answer is coming
+        m_progress.dumped += count;
+        if(req.received >= total)
+        {
+          m_in_flight.erase(it);
+          m_progress.answered++;
+          if(m_window < m_max_window)
+            m_window++;
+        }
+      });
+    }
+
+    // The remote does not support dumps.
+    void dump_failed(string_view address)
+    {
+      locked([&] {
+        auto it = m_in_flight.find(address);
+        if(it != m_in_flight.end() && it->second.kind == minuit_crawl_request::Dump)
+          fall_back(it);
+      });
+    }
+
+    // Retransmits the requests whose answer is late.
+    // Called by the crawler's thread ; public so that it can be driven by hand.
+    void tick(clock::time_point now)
+    {
+      locked([&] {
+        bool timed_out = false;
+        for(auto it = m_in_flight.begin(); it != m_in_flight.end(); )
+        {
+          auto& req = it->second;
+          if(now - req.sent_at < m_timeout)
+          {
+            ++it;
+            continue;
+          }
+
+          timed_out = true;
+          if(req.retries < m_max_retries)
+          {
+            req.retries++;
+            req.sent_at = now;
+            req.received = 0;
+            m_progress.retried++;
+            m_send(req.kind, it->first);
+            ++it;
+          }
+          else if(req.kind == minuit_crawl_request::Dump)
+          {
+            it = fall_back(it);
+          }
+          else
+          {
+            m_progress.failed++;
+            it = m_in_flight.erase(it);
+          }
+        }
+
+        // Back off : the remote or the link are overloaded.
+        if(timed_out)
+          m_window = std::max<std::size_t>(m_window / 2, 1);
+      });
+    }
+
+    bool running() const
+    {
+      std::lock_guard<std::mutex> l{m_mutex};
+      return m_active;
+    }
+
+    minuit_crawl_progress progress() const
+    {
+      std::lock_guard<std::mutex> l{m_mutex};
+      return current_progress();
+    }
+
+  private:
+    struct in_flight_request
+    {
+        minuit_crawl_request kind;
+        clock::time_point sent_at;
+        int retries{};
+        std::size_t received{}; // For dumps
+    };
+
+    struct queued_request
+    {
+        minuit_crawl_request kind;
+        std::string address;
+    };
+
+    minuit_crawl_progress current_progress() const
+    {
+      auto p = m_progress;
+      p.in_flight = m_in_flight.size();
+      p.queued = m_namespace_queue.size() + m_get_queue.size();
+      p.window = m_window;
+      return p;
+    }
+
+    // Runs f with the lock held, then sends what the window allows
+    // and calls the callbacks once the lock is released.
+    template<typename Fun>
+    void locked(Fun f)
+    {
+      progress_fun on_progress;
+      finished_fun on_finished;
+      minuit_crawl_progress p;
+      {
+        std::lock_guard<std::mutex> l{m_mutex};
+        f();
+        if(!m_active)
+          return;
+
+        pump();
+        p = current_progress();
+        on_progress = m_on_progress;
+
+        if(m_in_flight.empty() && m_namespace_queue.empty() && m_get_queue.empty())
+        {
+          m_active = false;
+          m_requested.clear();
+          on_finished = m_on_finished;
+        }
+        else
+        {
+          // The timeout thread may be waiting for the first request.
+          m_cv.notify_one();
+        }
+      }
+
+      if(on_progress)
+        on_progress(p);
+      if(on_finished)
+        on_finished(p);
+    }
+
+    void push(minuit_crawl_request kind, string_view address)
+    {
+      // The key is prefixed with the kind of request,
+      // so that a dump and a namespace request of an address differ.
+      std::string key;
+      key.reserve(address.size() + 1);
+      key.push_back(static_cast<char>('0' + static_cast<int>(kind)));
+      key.append(address.data(), address.size());
+      if(!m_requested.insert(std::move(key)).second)
+        return;
+
+      std::string str{address.data(), address.size()};
+      auto& queue = kind != minuit_crawl_request::Get ? m_namespace_queue : m_get_queue;
+      queue.push_back({kind, std::move(str)});
+    }
+
+    template<typename It>
+    It fall_back(It it)
+    {
+      m_progress.fallbacks++;
+      auto address = it->first;
+      it = m_in_flight.erase(it);
+      push(minuit_crawl_request::Namespace, address);
+      return it;
+    }
+
+    void pump()
+    {
+      const auto now = clock::now();
+      while(m_in_flight.size() < m_window)
+      {
+        auto& queue = !m_namespace_queue.empty() ? m_namespace_queue : m_get_queue;
+        if(queue.empty())
+          break;
+
+        auto req = std::move(queue.front());
+        queue.pop_front();
+
+        auto it = m_in_flight.emplace(std::move(req.address), in_flight_request{req.kind, now}).first;
+        m_progress.sent++;
+        m_send(req.kind, it->first);
+      }
+    }
+
+    void run()
+    {
+      std::unique_lock<std::mutex> l{m_mutex};
+      while(m_running)
+      {
+        if(!m_active || m_in_flight.empty())
+        {
+          m_cv.wait(l);
+          continue;
+        }
+
+        auto first = std::min_element(
+                       m_in_flight.begin(), m_in_flight.end(),
+                       [] (const auto& lhs, const auto& rhs) {
+          return lhs.second.sent_at < rhs.second.sent_at;
+        });
+        const auto due = first->second.sent_at + m_timeout;
+        if(clock::now() < due)
+        {
+          m_cv.wait_until(l, due);
+          continue;
+        }
+
+        l.unlock();
+        tick(clock::now());
+        l.lock();
+      }
+    }
+
+    send_fun m_send;
+    progress_fun m_on_progress;
+    finished_fun m_on_finished;
+
+    std::deque<queued_request> m_namespace_queue;
+    std::deque<queued_request> m_get_queue;
+    std::map<std::string, in_flight_request, std::less<>> m_in_flight;
+    std::unordered_set<std::string> m_requested;
+    minuit_crawl_progress m_progress;
+
+    std::size_t m_max_window{32};
+    std::size_t m_window{32};
+    clock::duration m_timeout{std::chrono::milliseconds(500)};
+    int m_max_retries{3};
+    bool m_active{};
+
+    bool m_running = true;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::thread m_thread;
+};
+
+}
+}
@@ -91,13 +91,10 @@ struct minuit_remote_behaviour<
       }
       else
       {
-        string_view address{full_address.data(), idx};
-
-        // Note : bug if address == "foo:"
-        auto attr = get_attribute(
-                      string_view(
-                        address.data() + idx + 1,
-                        full_address.size() - idx - 1));
+        string_view address;
+        minuit_attribute attr;
+        if(!split_attribute(full_address, address, attr))
+          return map.end();
 
         ++mess_it;
         // mess_it is now at the first argument after the address:attribute
@@ -105,7 +102,8 @@ struct minuit_remote_behaviour<
         switch(attr)
         {
           case minuit_attribute::Value:
-            return handle_value(dev, map, address, mess_it, mess);
+            // handle_value skips the address:attribute argument itself.
+            return handle_value(dev, map, address, mess.ArgumentsBegin(), mess);
           case minuit_attribute::Type:
             // default-initialize with the type
             return map.update_attributes(
@@ -127,13 +125,17 @@ struct minuit_remote_behaviour<
                   address,
                   RepetitionFilter{mess_it->AsBool()});
             break;
+          case minuit_attribute::Priority:
+            return map.update_attributes(
+                  address,
+                  Priority{mess_it->AsInt32()});
+            break;
           case minuit_attribute::Service:
             return map.update_attributes(
                   address,
                   from_minuit_service_text(mess_it->AsString()));
             break;
 
-          case minuit_attribute::Priority:
           case minuit_attribute::Description:
           default:
             break;
@@ -273,7 +275,7 @@ struct minuit_remote_behaviour<
           auto str = address.to_string();
           str.push_back(':');
           str.append(attrib.begin(), attrib.end());
-          dev.sender.send(sub_request, string_view(str));
+          dev.request_get(sub_request, string_view(str));
         }
       }
     }
@@ -318,5 +320,84 @@ struct minuit_remote_behaviour<
     }
 };
 
+// Dump (extension), see minuit_local_behaviour for the format.
+template<>
+struct minuit_remote_behaviour<
+    minuit_command::Answer,
+    minuit_operation::Dump>
+{
+    // The end of the count arguments starting at it.
+    static auto advance(
+        oscpack::ReceivedMessageArgumentIterator it,
+        oscpack::ReceivedMessageArgumentIterator end_it,
+        int32_t count)
+    {
+      for(; count > 0 && it != end_it; --count)
+        ++it;
+      return it;
+    }
+
+    static void read_bound(
+        oscpack::ReceivedMessageArgumentIterator& it,
+        oscpack::ReceivedMessageArgumentIterator end_it,
+        Variant& bound)
+    {
+      const auto count = (it++)->AsInt32();
+      auto bound_end = advance(it, end_it, count);
+      if(count == 1)
+      {
+        read_argument(*it, bound);
+      }
+      else if(count > 1)
+      {
+        Tuple t;
+        convert_tuple(it, bound_end, t);
+        bound = std::move(t);
+      }
+      it = bound_end;
+    }
+
+    // Returns the number of parameters in the message.
+    template<typename Device, typename Map>
+    std::size_t operator()(Device&, Map& map, const oscpack::ReceivedMessage& mess)
+    {
+      if(mess.ArgumentCount() < 2)
+        return 0;
+
+      // Requested address and total number of parameters
+      auto it = mess.ArgumentsBegin();
+      const auto end_it = mess.ArgumentsEnd();
+      ++it;
+      ++it;
+
+      std::size_t n = 0;
+      while(it != end_it)
+      {
+        Parameter p;
+        p.destination = (it++)->AsString();
+        static_cast<Value&>(p) = from_minuit_type_text((it++)->AsString());
+        static_cast<Access&>(p) = from_minuit_service_text((it++)->AsString());
+        static_cast<Bounding&>(p) = from_minuit_bounding_text((it++)->AsString());
+        p.repetitionFilter = (it++)->AsInt32();
+        p.priority = (it++)->AsInt32();
+
+        const auto count = (it++)->AsInt32();
+        auto value_end = advance(it, end_it, count);
+        read_value_in_place(it, value_end, p);
+        it = value_end;
+
+        read_bound(it, end_it, p.min);
+        read_bound(it, end_it, p.max);
+
+        if(map.find(p.destination) == map.end())
+          map.insert(std::move(p));
+        else
+          map.replace(p);
+        n++;
+      }
+      return n;
+    }
+};
+
 }
 }
@@ -46,6 +46,11 @@ class minuit_remote_impl : public osc_local_device<
         sender.send(act, string_view(root));
     }
 
+    auto request_get(string_view act, string_view address)
+    {
+        sender.send(act, address);
+    }
+
     minuit_name_table nameTable;
 };
 }
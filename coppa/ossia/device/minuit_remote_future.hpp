@@ -4,11 +4,16 @@
 #include <coppa/ossia/device/minuit_remote_future_behaviour.hpp>
 #include <coppa/ossia/device/message_handler.hpp>
 #include <coppa/ossia/device/minuit_name_table.hpp>
+#include <coppa/ossia/device/minuit_namespace_crawler.hpp>
+#include <coppa/ossia/device/minuit_get_table.hpp>
 #include <coppa/map.hpp>
 
 #include <coppa/protocol/osc/oscreceiver.hpp>
 #include <coppa/protocol/osc/oscsender.hpp>
 
+#include <atomic>
+#include <mutex>
+
 namespace coppa
 {
 namespace ossia
@@ -26,13 +31,27 @@ class minuit_remote_impl_future : public osc_local_device<
         unsigned int in_port,
         std::string out_ip,
         unsigned int out_port):
-      osc_local_device{map, in_port, out_ip, out_port,
+      osc_local_device{deferred_run, map, in_port, out_ip, out_port,
                        [&] (const auto& m, const auto& ip) {
       data_handler_t::on_messageReceived(*this, this->map(), m, ip);
     }},
       nameTable{name}
     {
+        m_crawler.on_finished([this] (const minuit_crawl_progress&) {
+            std::lock_guard<std::mutex> l{m_nsMutex};
+            m_nsRunning = false;
+            m_nsPromise.set_value();
+        });
+
+        // The replies use the get table and the crawler :
+        // they are received once these are built...
+        this->server.run();
+    }
 
+    // ... and until they are destroyed.
+    ~minuit_remote_impl_future()
+    {
+        this->server.stop();
     }
 
     void set_name(const std::string& n)
@@ -40,15 +59,36 @@ class minuit_remote_impl_future : public osc_local_device<
     std::string get_name() const
     { return nameTable.get_device_name().to_string(); }
 
-    auto pull(const std::string& address)
+    // The future fails with a TimeoutException if there is no reply
+    // within the pull timeout. Concurrent pulls of an address share a request.
+    std::future<Parameter> pull(const std::string& address)
     {
-        auto act = nameTable.get_action(minuit_action::GetRequest);
-        this->sender.send(act, string_view(address));
+        auto res = m_gets.add(address, minuit_get_table::clock::now() + pull_timeout());
+        if(res.second)
+        {
+            auto act = nameTable.get_action(minuit_action::GetRequest);
+            this->sender.send(act, string_view(address));
+        }
+        return std::move(res.first);
+    }
+
+    // The values are in the order of the addresses.
+    std::future<std::vector<Parameter>> pull_many(const std::vector<std::string>& addresses)
+    {
+        auto res = m_gets.add_many(addresses, minuit_get_table::clock::now() + pull_timeout());
 
-        m_getPromises.emplace_back(address);
-        return m_getPromises.back().promise.get_future();
+        auto act = nameTable.get_action(minuit_action::GetRequest);
+        for(const auto& address : res.second)
+            this->sender.send(act, string_view(address));
+        return std::move(res.first);
     }
 
+    void set_pull_timeout(std::chrono::steady_clock::duration t)
+    { m_pullTimeout = t.count(); }
+
+    std::chrono::steady_clock::duration pull_timeout() const
+    { return std::chrono::steady_clock::duration{m_pullTimeout.load()}; }
+
     void listen(const std::string& address, bool b)
     {
       auto act = nameTable.get_action(minuit_action::ListenRequest);
@@ -58,39 +98,85 @@ class minuit_remote_impl_future : public osc_local_device<
         this->sender.send(act, string_view(address), "disable");
     }
 
-    auto refresh()
+    // The future is ready once every request of the crawl
+    // was answered or given up ; see crawl_progress().
+    std::shared_future<void> refresh()
     {
-        if(m_namespaceRequests.empty())
+        std::unique_lock<std::mutex> l{m_nsMutex};
+        if(!m_nsRunning)
         {
             map().clear();
-            auto act = nameTable.get_action(minuit_action::NamespaceRequest);
-            this->sender.send(act, string_view("/"));
-
+            m_nsRunning = true;
             m_nsPromise = std::promise<void>{};
-            return m_nsPromise.get_future();
-        }
-        else
-        {
-            return m_nsPromise.get_future();
+            m_nsFuture = m_nsPromise.get_future().share();
+            auto fut = m_nsFuture;
+
+            // The crawl may finish, and lock m_nsMutex, during start().
+            l.unlock();
+            m_crawler.start("/", nameTable.dump_extension()
+                             ? minuit_crawl_request::Dump
+                             : minuit_crawl_request::Namespace);
+            return fut;
         }
+        return m_nsFuture;
     }
 
-    auto refresh(string_view act, const std::string& root)
+    // Called for the children found by the crawl.
+    auto refresh(string_view, const std::string& root)
     {
-        auto it = m_namespaceRequests.find(root);
-        if(it == m_namespaceRequests.end())
-        {
-            m_namespaceRequests.insert(root);
+        m_crawler.request(minuit_crawl_request::Namespace, string_view(root));
+    }
 
-            sender.send(act, string_view(root));
-        }
+    // Called for the attributes of the leaves found by the crawl.
+    auto request_get(string_view, string_view address)
+    {
+        m_crawler.request(minuit_crawl_request::Get, address);
     }
 
+    // Maximal number of requests in flight during a crawl.
+    void set_crawl_window(std::size_t n)
+    { m_crawler.set_window(n); }
+
+    // A request is sent again if it has no answer after t,
+    // at most n times.
+    void set_crawl_timeout(std::chrono::steady_clock::duration t, int n)
+    {
+        m_crawler.set_timeout(t);
+        m_crawler.set_max_retries(n);
+    }
+
+    void on_crawl_progress(minuit_namespace_crawler::progress_fun f)
+    { m_crawler.on_progress(std::move(f)); }
+
+    minuit_crawl_progress crawl_progress() const
+    { return m_crawler.progress(); }
+
     minuit_name_table nameTable;
 
-    std::list<get_promise> m_getPromises;
+    minuit_get_table m_gets;
+    std::atomic<std::chrono::steady_clock::rep> m_pullTimeout{
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::seconds(5)).count()};
+    // The namespace crawl ; shared by the users that call refresh() during it.
+    std::mutex m_nsMutex;
     std::promise<void> m_nsPromise;
-    std::set<std::string, std::less<>> m_namespaceRequests; // TODO http://libcds.sourceforge.net/
+    std::shared_future<void> m_nsFuture;
+    bool m_nsRunning{};
+
+    minuit_namespace_crawler m_crawler{
+        [this] (minuit_crawl_request req, string_view address) {
+            switch(req)
+            {
+                case minuit_crawl_request::Namespace:
+                    this->sender.send(nameTable.get_action(minuit_action::NamespaceRequest), address);
+                    break;
+                case minuit_crawl_request::Get:
+                    this->sender.send(nameTable.get_action(minuit_action::GetRequest), address);
+                    break;
+                case minuit_crawl_request::Dump:
+                    this->sender.send(nameTable.get_action(minuit_action::DumpRequest), address);
+                    break;
+            }
+        }};
 };
 
 }
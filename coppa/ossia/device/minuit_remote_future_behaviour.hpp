@@ -11,14 +11,6 @@ namespace coppa
 namespace ossia
 {
 
-struct get_promise
-{
-        get_promise(const std::string& addr):
-            address{addr} { }
-        std::string address;
-        std::promise<coppa::ossia::Parameter> promise;
-};
-
 template<
         template<
           minuit_command,
@@ -47,30 +39,51 @@ struct minuit_callback_behaviour_wrapper<Handler, minuit_command::Answer, minuit
     auto operator()(Device& dev, Map& map, const oscpack::ReceivedMessage& mess)
     {
         auto res_it = Handler<minuit_command::Answer, minuit_operation::Get>{}(dev, map, mess);
+        if(mess.ArgumentCount() > 0)
+        {
+          dev.m_crawler.answered(mess.ArgumentsBegin()->AsString());
+        }
 
         if(res_it != map.end())
         {
-            // TODO for all if instead ?
-            auto prom_it = std::find_if(
-                        dev.m_getPromises.begin(),
-                        dev.m_getPromises.end(),
-                        [=] (const auto& prom) {
-               return prom.address == res_it->destination;
-            });
-
-            if(prom_it != dev.m_getPromises.end())
-            {
-              prom_it->promise.set_value(*res_it);
-              dev.m_getPromises.erase(prom_it);
-            }
+            dev.m_gets.fulfill(res_it->destination, *res_it);
         }
-        // TODO here : - boost.lockfree queue for namespaces : we add the requested paths to a queue
-        // when they are received we remove them
-        // when the queue is empty, the namespace querying is finished (else we retry three times or something)
+    }
+};
 
-        // For "get" we set our promise as soon as we're done ? where shall we store them ?
+template<
+        template<
+          minuit_command,
+          minuit_operation>
+        class Handler>
+struct minuit_callback_behaviour_wrapper<Handler, minuit_command::Answer, minuit_operation::Dump>
+{
+    template<typename Device, typename Map>
+    auto operator()(Device& dev, Map& map, const oscpack::ReceivedMessage& mess)
+    {
+      auto n = Handler<minuit_command::Answer, minuit_operation::Dump>{}(dev, map, mess);
+      if(mess.ArgumentCount() >= 2)
+      {
+        auto it = mess.ArgumentsBegin();
+        string_view address = it->AsString();
+        const auto total = (++it)->AsInt32();
+        dev.m_crawler.dump_received(address, n, total);
+      }
+    }
+};
 
-        //dev.m_getPromises
+template<
+        template<
+          minuit_command,
+          minuit_operation>
+        class Handler>
+struct minuit_callback_behaviour_wrapper<Handler, minuit_command::Error, minuit_operation::Dump>
+{
+    template<typename Device, typename Map>
+    auto operator()(Device& dev, Map&, const oscpack::ReceivedMessage& mess)
+    {
+      if(mess.ArgumentCount() >= 1)
+        dev.m_crawler.dump_failed(mess.ArgumentsBegin()->AsString());
     }
 };
 
@@ -108,17 +121,10 @@ struct minuit_callback_behaviour_wrapper<Handler, minuit_command::Answer, minuit
       string_view address = it->AsString();
       auto type = get_type((++it)->AsString()[0]);
 
+      // The children are requested before the answer is acknowledged,
+      // so that the crawl does not end early.
       impl_t::handle_minuit(dev, map, address, type, it, mess.ArgumentsEnd());
-
-      auto ns_it = dev.m_namespaceRequests.find(address);
-      if(ns_it != dev.m_namespaceRequests.end())
-      {
-        dev.m_namespaceRequests.erase(ns_it);
-        if(dev.m_namespaceRequests.empty())
-        {
-          dev.m_nsPromise.set_value();
-        }
-      }
+      dev.m_crawler.answered(address);
     }
 };
 }
@@ -1,8 +1,11 @@
 #pragma once
 #include <oscpack/osc/OscReceivedElements.h>
 #include <coppa/ossia/parameter.hpp>
+#include <coppa/ossia/bounding.hpp>
 #include <oscpack/osc/OscTypesTraits.h>
+#include <coppa/protocol/osc/oscbulk.hpp>
 #include <coppa/exceptions/BadRequest.hpp>
+#include <type_traits>
 
 namespace coppa
 {
@@ -45,13 +48,14 @@ void convert_numeric(oscpack::ReceivedMessageArgument arg, T& val)
 inline void convert_string(oscpack::ReceivedMessageArgument arg, std::string& val)
 {
   using namespace oscpack;
+  // assign() reuses the capacity of the current string.
   switch(arg.TypeTag())
   {
     case STRING_TYPE_TAG:
-      val = convert<STRING_TYPE_TAG>(arg);
+      val.assign(arg.AsStringUnchecked());
       break;
     case SYMBOL_TYPE_TAG:
-      val = convert<SYMBOL_TYPE_TAG>(arg);
+      val.assign(arg.AsSymbolUnchecked());
       break;
     default:
       break;
@@ -59,56 +63,114 @@ inline void convert_string(oscpack::ReceivedMessageArgument arg, std::string& va
   }
 }
 
+// Stores the value of a single argument into elt, which takes its type.
+// A string or blob element keeps its capacity.
+// Returns false if the type of the argument is not supported.
+inline bool read_argument(
+    const oscpack::ReceivedMessageArgument& arg,
+    Variant& elt)
+{
+  using namespace oscpack;
+  switch(arg.TypeTag())
+  {
+    // TODO nil / impulse ?
+    case TRUE_TYPE_TAG:
+      elt = true;
+      return true;
+    case FALSE_TYPE_TAG:
+      elt = false;
+      return true;
+    case INT32_TYPE_TAG:
+      elt = arg.AsInt32Unchecked();
+      return true;
+    case INT64_TYPE_TAG:
+      elt = int32_t(arg.AsInt64Unchecked());
+      return true;
+    case FLOAT_TYPE_TAG:
+      elt = arg.AsFloatUnchecked();
+      return true;
+    case DOUBLE_TYPE_TAG:
+      elt = float(arg.AsDoubleUnchecked());
+      return true;
+    case CHAR_TYPE_TAG:
+      elt = arg.AsCharUnchecked();
+      return true;
+    case STRING_TYPE_TAG:
+    case SYMBOL_TYPE_TAG:
+    {
+      auto str = arg.TypeTag() == STRING_TYPE_TAG
+          ? arg.AsStringUnchecked()
+          : arg.AsSymbolUnchecked();
+      if(auto cur = elt.target<std::string>())
+        cur->assign(str);
+      else
+        elt = std::string(str);
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
+// Reads the argument into the element at index i of the variants,
+// which is appended if needed. Returns the index of the next element.
+inline std::size_t read_argument(
+    const oscpack::ReceivedMessageArgument& arg,
+    std::vector<Variant>& variants,
+    std::size_t i)
+{
+  if(i == variants.size())
+    variants.emplace_back();
+  return read_argument(arg, variants[i]) ? i + 1 : i;
+}
+
+// The elements of the tuple are overwritten, and the extra ones removed :
+// a tuple that keeps the same size does not allocate.
 inline void convert_tuple(
     oscpack::ReceivedMessageArgumentIterator it,
     oscpack::ReceivedMessageArgumentIterator end_it,
     Tuple& tuple)
 {
-  using namespace oscpack;
-
-  // Setup
-  tuple.variants.clear();
-
-  // Handle single value case
+  std::size_t i = 0;
   for(;it != end_it; ++it)
   {
-    auto& arg = *it;
-    auto type = arg.TypeTag();
+    i = read_argument(*it, tuple.variants, i);
+  }
+  tuple.variants.resize(i);
+}
 
-    switch(type)
+// Like convert_tuple with all the arguments of the message,
+// but the long runs of int32 or float arguments are decoded in bulk.
+inline void convert_tuple(
+    const oscpack::ReceivedMessage& m,
+    Tuple& tuple)
+{
+  std::size_t i = 0;
+  auto pos = osc::arguments_begin(m);
+  for(auto it = m.ArgumentsBegin(), end_it = m.ArgumentsEnd(); it != end_it; )
+  {
+    const auto run = osc::numeric_run(pos.tag);
+    if(run >= osc::bulk_threshold)
     {
-      // TODO nil / impulse ?
-      case TRUE_TYPE_TAG:
-        tuple.variants.push_back(convert<TRUE_TYPE_TAG>(arg));
-        break;
-      case FALSE_TYPE_TAG:
-        tuple.variants.push_back(convert<FALSE_TYPE_TAG>(arg));
-        break;
-      case INT32_TYPE_TAG:
-        tuple.variants.push_back(convert<INT32_TYPE_TAG>(arg));
-        break;
-      case INT64_TYPE_TAG:
-        tuple.variants.push_back(int32_t(convert<INT64_TYPE_TAG>(arg)));
-        break;
-      case FLOAT_TYPE_TAG:
-        tuple.variants.push_back(convert<FLOAT_TYPE_TAG>(arg));
-        break;
-      case DOUBLE_TYPE_TAG:
-        tuple.variants.push_back(float(convert<DOUBLE_TYPE_TAG>(arg)));
-        break;
-      case CHAR_TYPE_TAG:
-        tuple.variants.push_back(convert<CHAR_TYPE_TAG>(arg));
-        break;
-      case STRING_TYPE_TAG:
-        tuple.variants.push_back(convert<STRING_TYPE_TAG>(arg));
-        break;
-      case SYMBOL_TYPE_TAG:
-        tuple.variants.push_back(convert<SYMBOL_TYPE_TAG>(arg));
-        break;
-      default:
+      osc::read_numeric_run(pos, run, tuple.variants, i);
+      i += run;
+      pos.tag += run;
+      pos.data += 4 * run;
+
+      // The iterator is only needed if there are other arguments.
+      if(*pos.tag == 0)
         break;
+      for(std::size_t k = 0; k < run; k++)
+        ++it;
+    }
+    else
+    {
+      i = read_argument(*it, tuple.variants, i);
+      pos.advance();
+      ++it;
     }
   }
+  tuple.variants.resize(i);
 }
 
 inline void convert_single_value(
@@ -146,7 +208,18 @@ inline void convert_single_value(
         int n = 0;
         const char* data{};
         it->AsBlob(reinterpret_cast<const void*&>(data), n);
-        val = coppa::Generic{std::string(data, n)};
+        val.buf.assign(data, n);
+      }
+      // The arrays are read from all the arguments, in read_value_in_place.
+      void operator()(float_array&) const {
+      }
+      void operator()(int_array&) const {
+      }
+      void operator()(vec2f&) const {
+      }
+      void operator()(vec3f&) const {
+      }
+      void operator()(vec4f&) const {
       }
 
   } visitor{arg};
@@ -154,28 +227,200 @@ inline void convert_single_value(
   eggs::variants::apply(visitor, elt);
 }
 
-inline coppa::ossia::Value read_value(
+// Reads each argument into an element of a homogeneous array ;
+// the size of the array follows the message.
+template<typename T>
+void convert_numeric_array(
     oscpack::ReceivedMessageArgumentIterator it,
     oscpack::ReceivedMessageArgumentIterator end_it,
-    coppa::ossia::Value& source)
+    std::vector<T>& array)
 {
-  auto cur_type = coppa::ossia::which(source.value);
+  std::size_t i = 0;
+  for(; it != end_it; ++it, ++i)
+  {
+    if(i == array.size())
+      array.emplace_back();
+    convert_numeric<T>(*it, array[i]);
+  }
+  array.resize(i);
+}
+
+// Fixed size : the extra arguments are ignored.
+template<std::size_t N>
+void convert_numeric_array(
+    oscpack::ReceivedMessageArgumentIterator it,
+    oscpack::ReceivedMessageArgumentIterator end_it,
+    std::array<float, N>& array)
+{
+  for(std::size_t i = 0; it != end_it && i < N; ++it, ++i)
+  {
+    convert_numeric<float>(*it, array[i]);
+  }
+}
+
+// Number of arguments if they all have the given type tag, else zero.
+inline std::size_t homogeneous_arguments(
+    const oscpack::ReceivedMessage& m,
+    char tag)
+{
+  const auto count = std::size_t(m.ArgumentCount());
+  const auto pos = osc::arguments_begin(m);
+  if(*pos.tag != tag || osc::numeric_run(pos.tag) != count)
+    return 0;
+  return count;
+}
+
+// If all the arguments have the type tag of the array,
+// they are byte-swapped directly into its storage.
+template<typename T>
+bool read_homogeneous_array(
+    const oscpack::ReceivedMessage& m,
+    std::vector<T>& array)
+{
+  const auto tag = std::is_same<T, float>::value
+      ? oscpack::FLOAT_TYPE_TAG
+      : oscpack::INT32_TYPE_TAG;
+  const auto count = homogeneous_arguments(m, tag);
+  if(count == 0)
+    return false;
+
+  array.resize(count);
+  osc::read_big_endian_32(osc::arguments_begin(m).data, count, array.data());
+  return true;
+}
+
+template<std::size_t N>
+bool read_homogeneous_array(
+    const oscpack::ReceivedMessage& m,
+    std::array<float, N>& array)
+{
+  if(homogeneous_arguments(m, oscpack::FLOAT_TYPE_TAG) != N)
+    return false;
+
+  osc::read_big_endian_32(osc::arguments_begin(m).data, N, array.data());
+  return true;
+}
+
+// Decodes the arguments directly into the value,
+// which keeps its current type.
+inline void read_value_in_place(
+    oscpack::ReceivedMessageArgumentIterator it,
+    oscpack::ReceivedMessageArgumentIterator end_it,
+    coppa::ossia::Value& dest)
+{
+  auto cur_type = coppa::ossia::which(dest.value);
   if(cur_type == Type::none_t || cur_type == Type::impulse_t)
-    return source;
+    return;
 
   if(it != end_it)
   {
-    if(cur_type != coppa::ossia::Type::tuple_t)
+    using namespace eggs::variants;
+    switch(cur_type)
     {
-      convert_single_value(it, source.value);
+      case Type::tuple_t:
+        convert_tuple(it, end_it, get<Tuple>(dest.value));
+        break;
+      case Type::float_array_t:
+        convert_numeric_array(it, end_it, get<float_array>(dest.value));
+        break;
+      case Type::int_array_t:
+        convert_numeric_array(it, end_it, get<int_array>(dest.value));
+        break;
+      case Type::vec2f_t:
+        convert_numeric_array(it, end_it, get<vec2f>(dest.value));
+        break;
+      case Type::vec3f_t:
+        convert_numeric_array(it, end_it, get<vec3f>(dest.value));
+        break;
+      case Type::vec4f_t:
+        convert_numeric_array(it, end_it, get<vec4f>(dest.value));
+        break;
+      default:
+        convert_single_value(it, dest.value);
+        break;
     }
-    else
+  }
+  // If it == end_it then we have an impulse.
+}
+
+// Same, for all the arguments of the message.
+inline void read_value_in_place(
+    const oscpack::ReceivedMessage& m,
+    coppa::ossia::Value& dest)
+{
+  using namespace eggs::variants;
+  if(m.ArgumentCount() > 0)
+  {
+    bool done = false;
+    switch(coppa::ossia::which(dest.value))
     {
-      convert_tuple(it, end_it, eggs::variants::get<Tuple>(source.value));
+      case Type::tuple_t:
+        convert_tuple(m, get<Tuple>(dest.value));
+        done = true;
+        break;
+      case Type::float_array_t:
+        done = read_homogeneous_array(m, get<float_array>(dest.value));
+        break;
+      case Type::int_array_t:
+        done = read_homogeneous_array(m, get<int_array>(dest.value));
+        break;
+      case Type::vec2f_t:
+        done = read_homogeneous_array(m, get<vec2f>(dest.value));
+        break;
+      case Type::vec3f_t:
+        done = read_homogeneous_array(m, get<vec3f>(dest.value));
+        break;
+      case Type::vec4f_t:
+        done = read_homogeneous_array(m, get<vec4f>(dest.value));
+        break;
+      default:
+        break;
     }
+    if(done)
+      return;
   }
-  // If it == end_it then we have an impulse.
 
+  read_value_in_place(m.ArgumentsBegin(), m.ArgumentsEnd(), dest);
+}
+
+// Decodes the message into the value of a parameter,
+// which is then bounded according to its range.
+// If the parameter filters repetitions, the message is decoded
+// aside and only stored if the value changed.
+// Returns false if the message was filtered.
+template<typename Parameter_T>
+bool update_value(
+    const oscpack::ReceivedMessage& m,
+    Parameter_T& p)
+{
+  auto& value = static_cast<coppa::ossia::Value&>(p);
+  // An impulse is never a repetition.
+  if(!p.repetitionFilter
+     || m.ArgumentCount() == 0
+     || which(value.value) == Type::impulse_t)
+  {
+    read_value_in_place(m, value);
+    apply_bounding(p);
+    return true;
+  }
+
+  coppa::ossia::Value received = value;
+  read_value_in_place(m, received);
+  if(p.bounding != Bounding::Mode::Free)
+    apply_bounding(p.bounding, static_cast<const Range&>(p), received.value);
+  if(same_value(received.value, value.value))
+    return false;
+
+  value = std::move(received);
+  return true;
+}
+
+inline coppa::ossia::Value read_value(
+    oscpack::ReceivedMessageArgumentIterator it,
+    oscpack::ReceivedMessageArgumentIterator end_it,
+    coppa::ossia::Value& source)
+{
+  read_value_in_place(it, end_it, source);
   return source;
 }
 
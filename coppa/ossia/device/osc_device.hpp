@@ -2,6 +2,8 @@
 #include <coppa/ossia/device/device_with_callbacks.hpp>
 #include <coppa/string_view.hpp>
 #include <coppa/ossia/parameter.hpp>
+#include <coppa/ossia/bounding.hpp>
+#include <coppa/protocol/osc/oscscheduler.hpp>
 #include <unordered_map>
 
 namespace coppa
@@ -18,7 +20,7 @@ namespace ossia
 
 
 // Shmem callbacks ?
-// IPC ?
+// IPC : see osc::shm_receiver / osc::shm_sender
 
 // Remote OSC device :
 // Can just send data to the outside
@@ -31,6 +33,12 @@ namespace ossia
 // Local Minuit device, that will reply to every client (registering & garbage collection)
 // Updating Minuit device
 
+// Passed to the constructor of osc_local_device so that it does not
+// start the server : a derived device whose members are used by the
+// handler starts it at the end of its own constructor.
+struct deferred_run_t { };
+static const constexpr deferred_run_t deferred_run{};
+
 template<typename Map,
          typename DataProtocolServer,
          typename DataProtocolHandler,
@@ -51,9 +59,42 @@ class osc_local_device :
         std::string out_ip,
         unsigned int out_port,
         Handler h):
+      osc_local_device{deferred_run, map, in_port, std::move(out_ip), out_port, h}
+    {
+      server.run();
+    }
+
+    template<typename Handler>
+    osc_local_device(
+        deferred_run_t,
+        Map& map,
+        unsigned int in_port,
+        std::string out_ip,
+        unsigned int out_port,
+        Handler h):
       sender{out_ip, int(out_port)},
       server{in_port, h},
       m_map{map}
+    {
+    }
+
+    // The bundles received are passed to bundle_handler
+    // as (const char* data, std::size_t size) when their time tag is due.
+    // See osc::bundle_scheduler.
+    template<typename Handler, typename BundleHandler>
+    osc_local_device(
+        Map& map,
+        unsigned int in_port,
+        std::string out_ip,
+        unsigned int out_port,
+        Handler h,
+        BundleHandler bundle_handler):
+      scheduler{bundle_handler},
+      sender{out_ip, int(out_port)},
+      server{in_port, h, [this] (const char* data, std::size_t size, const auto&) {
+        scheduler.schedule(data, size);
+      }},
+      m_map{map}
     {
       server.run();
     }
@@ -88,11 +129,25 @@ class osc_local_device :
         return map().find(address);
     }
 
+    // The value is bounded according to the range of the parameter.
+    // Nothing is sent if the parameter filters repetitions
+    // and already has this value.
     template<typename Values_T>
     auto push(const std::string& address, Values_T&& values)
     {
-        this->sender.send(address, values);
-        this->set(address, std::forward<Values_T>(values));
+        coppa::ossia::Value value{std::forward<Values_T>(values)};
+        bool repeated = false;
+        this->template update<std::string>(address, [&] (auto& p) {
+            auto& current = static_cast<coppa::ossia::Value&>(p);
+            if(p.bounding != Bounding::Mode::Free)
+              apply_bounding(p.bounding, static_cast<const Range&>(p), value.value);
+            repeated = p.repetitionFilter && same_value(current.value, value.value);
+            if(!repeated)
+              current = value;
+        });
+
+        if(!repeated)
+          this->sender.send(address, value);
     }
 
     template<typename Values_T>
@@ -100,6 +155,7 @@ class osc_local_device :
     {
         this->template update<std::string>(address, [&] (auto& p) {
             static_cast<coppa::ossia::Value&>(p) = std::forward<Values_T>(values);
+            apply_bounding(p);
         });
     }
 
@@ -124,15 +180,42 @@ class osc_local_device :
         });
     }
 
+    // Senders which schedule by priority, e.g. osc::coalescing_sender,
+    // get it too : it then also applies to the children of the address
+    // which have none.
+    // This is the only place where the sender gets the priorities :
+    // a Priority set when inserting the parameter, or received from
+    // a Minuit remote, only changes the map.
+    auto set_priority(const std::string& address, int32_t priority)
+    {
+        this->template update<std::string>(address, [&] (auto& p) {
+            p.priority = priority;
+        });
+        set_sender_priority(sender, address, priority);
+    }
+
     auto set_range(const std::string& address, coppa::ossia::Range&& r)
     {
         m_map.update_attributes(address, std::move(r));
     }
 
+    coppa::osc::bundle_scheduler scheduler;
     DataProtocolSender sender;
     DataProtocolServer server;
 
   private:
+    template<typename Sender>
+    static auto set_sender_priority(Sender& s, const std::string& address, int32_t priority)
+      -> decltype(s.set_priority(address, priority), void())
+    {
+        s.set_priority(address, priority);
+    }
+
+    template<typename... Args>
+    static void set_sender_priority(Args&&...)
+    {
+    }
+
     Map& m_map;
 
 };
@@ -27,6 +27,11 @@ class osc_local_impl : public osc_local_device<
       osc_local_device{map, in_port, out_ip, out_port,
                        [&] (const auto& m, const auto& ip) {
       data_handler_t::on_messageReceived(*this, this->map(), m, ip);
+    },
+                       [&] (const char* data, std::size_t size) {
+      data_handler_t::on_bundleReceived(
+            *this, this->map(),
+            oscpack::ReceivedBundle{oscpack::ReceivedPacket{data, static_cast<int>(size)}});
     }},
       m_name{name}
     {
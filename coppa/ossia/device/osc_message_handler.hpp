@@ -1,9 +1,14 @@
 #pragma once
 #include <coppa/protocol/osc/oscreceiver.hpp>
+#include <coppa/protocol/osc/oscbundle.hpp>
 #include <coppa/ossia/parameter.hpp>
 #include <coppa/ossia/device/osc_common.hpp>
 #include <coppa/ossia/osc/osc.hpp>
+#include <coppa/ossia/osc/value_view.hpp>
 #include <coppa/string_view.hpp>
+#include <type_traits>
+#include <utility>
+#include <vector>
 namespace coppa
 {
 namespace ossia
@@ -11,28 +16,72 @@ namespace ossia
 
 struct convert_osc_handler
 {
-    template<typename Device>
+    // A device which notifies the updates itself, e.g. to the clients
+    // listening to it, applies the message in its receive_osc method.
+    // Else the node is found once, through the map's address cache,
+    // and the arguments are decoded directly into its value,
+    // with the write lock held.
+    // The value callbacks of the address are then called, without the lock.
+    // The view callbacks read the message itself and need no copy.
+    // A repeated value is dropped if the parameter filters repetitions.
+    template<typename Device, typename Map>
     void operator()(
         Device& dev,
-        Value current_parameter,
+        Map& map,
         string_view address,
         const oscpack::ReceivedMessage& m)
     {
-      using namespace coppa;
-      using coppa::ossia::Parameter;
-      using eggs::variants::get;
-
-        // TODO not used ?
-      Value res = read_value(
-             m.ArgumentsBegin(),
-             m.ArgumentsEnd(),
-             current_parameter);
-
-      dev.template update<string_view>(
-            address,
-            [&] (auto& v) {
-        v.value = current_parameter.value;
-      });
+      apply(dev, map, address, m, 0);
+    }
+
+  private:
+    template<typename Device, typename Map>
+    static auto apply(
+        Device& dev,
+        Map&,
+        string_view address,
+        const oscpack::ReceivedMessage& m,
+        int)
+      -> decltype(dev.receive_osc(address, m), void())
+    {
+      dev.receive_osc(address, m);
+    }
+
+    template<typename Device, typename Map>
+    static void apply(
+        Device& dev,
+        Map& map,
+        string_view address,
+        const oscpack::ReceivedMessage& m,
+        long)
+    {
+      decltype(dev.find_value_callback(std::string{})) callback{};
+      decltype(dev.find_view_callback(std::string{})) view_callback{};
+      Value notified;
+      {
+        auto l = map.acquire_write_lock();
+        auto& data_map = map.get_data_map();
+        auto node_it = data_map.find_cached(address);
+        if(node_it == data_map.end())
+          return;
+
+        bool changed = true;
+        data_map.update_in_place(node_it, [&] (auto& p) {
+          changed = update_value(m, p);
+        });
+        if(!changed)
+          return;
+
+        callback = dev.find_value_callback(node_it->destination);
+        if(callback)
+          notified = *node_it;
+        view_callback = dev.find_view_callback(node_it->destination);
+      }
+
+      if(callback)
+        (*callback)(notified);
+      if(view_callback)
+        (*view_callback)(value_view{address, m});
     }
 };
 
@@ -46,18 +95,121 @@ class osc_message_handler : public coppa::osc::receiver
         const oscpack::ReceivedMessage& m,
         const oscpack::IpEndpointName& ip)
     {
-      string_view address{m.AddressPattern()};
-      Value current_parameter;
+      convert_osc_handler{}(dev, map, string_view{m.AddressPattern()}, m);
+    }
 
+    // All the messages of a bundle are applied in a single transaction :
+    // other threads see either none or all of them.
+    // The value callbacks are called once the bundle is applied.
+    // A nested bundle with a later time tag is passed to the scheduler
+    // of the device, if it has one, and applied at its own time ;
+    // else it is applied with the enclosing bundle.
+    template<typename Device, typename Map>
+    static void on_bundleReceived(
+        Device& dev,
+        Map& map,
+        const oscpack::ReceivedBundle& b)
+    {
+      using callback_t = decltype(dev.find_value_callback(std::string{}));
+      using view_callback_t = decltype(dev.find_view_callback(std::string{}));
+      std::vector<std::pair<callback_t, Value>> notified;
+      std::vector<std::pair<view_callback_t, oscpack::ReceivedMessage>> viewed;
+      std::vector<oscpack::ReceivedBundleElement> later;
       {
-        auto node_it = map.find(address);
-        if(node_it == map.end())
-          return;
-
-        current_parameter = *node_it;
+        auto l = map.acquire_write_lock();
+        apply_bundle(dev, map.get_data_map(), b, b.TimeTag(), notified, viewed, later);
       }
 
-      convert_osc_handler{}(dev, std::move(current_parameter), address, m);
+      for(auto& n : notified)
+        (*n.first)(n.second);
+      for(auto& v : viewed)
+        (*v.first)(value_view{string_view{v.second.AddressPattern()}, v.second});
+
+      // Without the lock : a late bundle is applied right away.
+      for(auto& e : later)
+        schedule(dev, e.Contents(), e.Size());
+    }
+
+  private:
+    template<typename Device, typename = void>
+    struct has_scheduler : std::false_type { };
+
+    template<typename Device>
+    struct has_scheduler<
+        Device,
+        decltype(std::declval<Device&>().scheduler.schedule(nullptr, std::size_t{}), void())> :
+        std::true_type { };
+
+    template<typename Device>
+    static void schedule(Device& dev, const char* data, std::size_t size)
+    {
+      schedule(dev, data, size, has_scheduler<Device>{});
+    }
+
+    template<typename Device>
+    static void schedule(Device& dev, const char* data, std::size_t size, std::true_type)
+    {
+      dev.scheduler.schedule(data, size);
+    }
+
+    template<typename Device>
+    static void schedule(Device&, const char*, std::size_t, std::false_type)
+    {
+    }
+
+    template<typename Device, typename DataMap, typename Notified, typename Viewed, typename Later>
+    static void apply_bundle(
+        Device& dev,
+        DataMap& map,
+        const oscpack::ReceivedBundle& b,
+        oscpack::uint64 time_tag,
+        Notified& notified,
+        Viewed& viewed,
+        Later& later)
+    {
+      for(auto it = b.ElementsBegin(); it != b.ElementsEnd(); ++it)
+      {
+        if(it->IsBundle())
+        {
+          oscpack::ReceivedBundle nested(*it);
+          const auto nested_tag = nested.TimeTag();
+          if(has_scheduler<Device>::value
+             && nested_tag != coppa::osc::immediate_time_tag
+             && nested_tag > time_tag)
+          {
+            later.push_back(*it);
+          }
+          else
+          {
+            apply_bundle(dev, map, nested, time_tag, notified, viewed, later);
+          }
+          continue;
+        }
+
+        try
+        {
+          oscpack::ReceivedMessage m(*it);
+          auto node_it = map.find_cached(string_view{m.AddressPattern()});
+          if(node_it == map.end())
+            continue;
+
+          bool changed = true;
+          map.update_in_place(node_it, [&] (auto& p) {
+            changed = update_value(m, p);
+          });
+          if(!changed)
+            continue;
+
+          if(auto callback = dev.find_value_callback(node_it->destination))
+            notified.emplace_back(callback, *node_it);
+          if(auto callback = dev.find_view_callback(node_it->destination))
+            viewed.emplace_back(callback, m);
+        }
+        catch(std::exception& e)
+        {
+          std::cerr << "OSC Parse Error: " << e.what() << std::endl;
+        }
+      }
     }
 };
 }
@@ -66,6 +66,26 @@ inline oscpack::OutboundPacketStream& operator<<(
       p << b;
       break;
     }
+    case Type::float_array_t:
+      for(float f : get<float_array>(val))
+        p << f;
+      break;
+    case Type::int_array_t:
+      for(int32_t i : get<int_array>(val))
+        p << i;
+      break;
+    case Type::vec2f_t:
+      for(float f : get<vec2f>(val))
+        p << f;
+      break;
+    case Type::vec3f_t:
+      for(float f : get<vec3f>(val))
+        p << f;
+      break;
+    case Type::vec4f_t:
+      for(float f : get<vec4f>(val))
+        p << f;
+      break;
     default:
       break;
   }
@@ -75,6 +95,38 @@ inline oscpack::OutboundPacketStream& operator<<(
 
 
 
+// Number of arguments written by operator<< for the variant.
+inline std::size_t argument_count(const coppa::ossia::Variant& val)
+{
+  using namespace eggs::variants;
+  using namespace coppa::ossia;
+  switch(which(val))
+  {
+    case Type::none_t:
+    case Type::impulse_t:
+      return 0;
+    case Type::tuple_t:
+    {
+      std::size_t n = 0;
+      for(const auto& elt : get<Tuple>(val).variants)
+        n += argument_count(elt);
+      return n;
+    }
+    case Type::float_array_t:
+      return get<float_array>(val).size();
+    case Type::int_array_t:
+      return get<int_array>(val).size();
+    case Type::vec2f_t:
+      return 2;
+    case Type::vec3f_t:
+      return 3;
+    case Type::vec4f_t:
+      return 4;
+    default:
+      return 1;
+  }
+}
+
 inline oscpack::OutboundPacketStream& operator<<(
     oscpack::OutboundPacketStream& p,
     const coppa::ossia::Range& range)
@@ -0,0 +1,105 @@
+#pragma once
+#include <oscpack/osc/OscReceivedElements.h>
+#include <coppa/ossia/parameter.hpp>
+#include <coppa/string_view.hpp>
+
+namespace coppa
+{
+namespace ossia
+{
+// Contents of a received blob, in the packet buffer.
+struct blob_view
+{
+    const char* data{};
+    std::size_t size{};
+
+    string_view str() const
+    { return string_view{data, size}; }
+};
+
+// A received argument. Strings and blobs are not copied.
+using VariantView = eggs::variant<None, Impulse, bool, int32_t, float, char, string_view, blob_view>;
+
+inline VariantView make_view(const oscpack::ReceivedMessageArgument& arg)
+{
+  using namespace oscpack;
+  switch(arg.TypeTag())
+  {
+    case TRUE_TYPE_TAG:
+      return true;
+    case FALSE_TYPE_TAG:
+      return false;
+    case INT32_TYPE_TAG:
+      return arg.AsInt32Unchecked();
+    case INT64_TYPE_TAG:
+      return int32_t(arg.AsInt64Unchecked());
+    case FLOAT_TYPE_TAG:
+      return arg.AsFloatUnchecked();
+    case DOUBLE_TYPE_TAG:
+      return float(arg.AsDoubleUnchecked());
+    case CHAR_TYPE_TAG:
+      return arg.AsCharUnchecked();
+    case STRING_TYPE_TAG:
+      return string_view{arg.AsStringUnchecked()};
+    case SYMBOL_TYPE_TAG:
+      return string_view{arg.AsSymbolUnchecked()};
+    case BLOB_TYPE_TAG:
+    {
+      int n = 0;
+      const char* data{};
+      arg.AsBlobUnchecked(reinterpret_cast<const void*&>(data), n);
+      return blob_view{data, std::size_t(n)};
+    }
+    case NIL_TYPE_TAG:
+      return None{};
+    default:
+      return Impulse{};
+  }
+}
+
+/**
+ * @brief The value_view class
+ *
+ * A received message, as given to the view callbacks of a device.
+ * It borrows the packet buffer : the views are only valid
+ * during the callback, and must be copied to be kept.
+ */
+class value_view
+{
+  public:
+    value_view(string_view address, const oscpack::ReceivedMessage& m):
+      m_address{address},
+      m_message{m}
+    {
+    }
+
+    string_view address() const
+    { return m_address; }
+
+    std::size_t size() const
+    { return m_message.ArgumentCount(); }
+
+    bool empty() const
+    { return size() == 0; }
+
+    // The first argument, e.g. for single values.
+    VariantView front() const
+    { return empty() ? VariantView{Impulse{}} : make_view(*m_message.ArgumentsBegin()); }
+
+    template<typename Fun>
+    void for_each(Fun f) const
+    {
+      for(auto it = m_message.ArgumentsBegin(); it != m_message.ArgumentsEnd(); ++it)
+        f(make_view(*it));
+    }
+
+    const oscpack::ReceivedMessage& message() const
+    { return m_message; }
+
+  private:
+    string_view m_address;
+    const oscpack::ReceivedMessage& m_message;
+};
+
+}
+}
@@ -1,6 +1,9 @@
 #pragma once
 #include <coppa/coppa.hpp>
 #include <boost/container/static_vector.hpp>
+#include <array>
+#include <cstring>
+#include <vector>
 #include <oscpack/osc/SmallString.h>
 namespace coppa
 {
@@ -15,11 +18,24 @@ using coppa::Destination;
 using coppa::Tags;
 using coppa::Generic;
 
-enum class Type { none_t, impulse_t, bool_t, int_t, float_t, char_t, string_t, tuple_t, generic_t };
+enum class Type { none_t, impulse_t, bool_t, int_t, float_t, char_t, string_t, tuple_t, generic_t,
+                  float_array_t, int_array_t, vec2f_t, vec3f_t, vec4f_t };
 struct None {};
 struct Impulse {};
 struct Tuple;
-using Variant = eggs::variant<None, Impulse, bool, int32_t, float, char, std::string, Tuple, Generic>;
+
+// Homogeneous numeric values, stored contiguously instead of
+// one Variant per element as in Tuple.
+// Like a Tuple, they are sent as a list of 'f' or 'i' arguments.
+using float_array = std::vector<float>;
+using int_array = std::vector<int32_t>;
+using vec2f = std::array<float, 2>;
+using vec3f = std::array<float, 3>;
+using vec4f = std::array<float, 4>;
+
+using Variant = eggs::variant<
+  None, Impulse, bool, int32_t, float, char, std::string, Tuple, Generic,
+  float_array, int_array, vec2f, vec3f, vec4f>;
 
 struct Tuple
 {
@@ -62,6 +78,11 @@ inline small_string getOSCType(const Variant& value)
     case Type::string_t: return small_string(1, STRING_TYPE_TAG);
     case Type::tuple_t: return getOSCType(get<Tuple>(value));
     case Type::generic_t: return  small_string(1, BLOB_TYPE_TAG);
+    case Type::float_array_t: return small_string(get<float_array>(value).size(), FLOAT_TYPE_TAG);
+    case Type::int_array_t: return small_string(get<int_array>(value).size(), INT32_TYPE_TAG);
+    case Type::vec2f_t: return small_string(2, FLOAT_TYPE_TAG);
+    case Type::vec3f_t: return small_string(3, FLOAT_TYPE_TAG);
+    case Type::vec4f_t: return small_string(4, FLOAT_TYPE_TAG);
     default: return small_string(1, NIL_TYPE_TAG);
   }
 }
@@ -89,12 +110,89 @@ inline bool operator==(const Impulse& , const Impulse& )
 inline bool operator==(const Tuple& lhs, const Tuple& rhs)
 { return lhs.variants == rhs.variants; }
 
+// Equality for the repetition filter.
+// The floats are compared bitwise : a repeated NaN is a repetition,
+// and -0 is not +0.
+inline bool same_value(const Variant& lhs, const Variant& rhs);
+
+inline bool same_floats(const float* lhs, const float* rhs, std::size_t n)
+{
+  return std::memcmp(lhs, rhs, n * sizeof(float)) == 0;
+}
+
+inline bool same_value(const Tuple& lhs, const Tuple& rhs)
+{
+  const auto n = lhs.variants.size();
+  if(n != rhs.variants.size())
+    return false;
+
+  for(std::size_t i = 0; i < n; i++)
+  {
+    if(!same_value(lhs.variants[i], rhs.variants[i]))
+      return false;
+  }
+  return true;
+}
+
+inline bool same_value(const Variant& lhs, const Variant& rhs)
+{
+  using namespace eggs::variants;
+  const auto t = which(lhs);
+  if(t != which(rhs))
+    return false;
+
+  switch(t)
+  {
+    case Type::none_t:
+    case Type::impulse_t:
+      return true;
+    case Type::bool_t:
+      return get<bool>(lhs) == get<bool>(rhs);
+    case Type::int_t:
+      return get<int32_t>(lhs) == get<int32_t>(rhs);
+    case Type::float_t:
+      return same_floats(&get<float>(lhs), &get<float>(rhs), 1);
+    case Type::char_t:
+      return get<char>(lhs) == get<char>(rhs);
+    case Type::string_t:
+      return get<std::string>(lhs) == get<std::string>(rhs);
+    case Type::tuple_t:
+      return same_value(get<Tuple>(lhs), get<Tuple>(rhs));
+    case Type::generic_t:
+      return get<Generic>(lhs).buf == get<Generic>(rhs).buf;
+    case Type::float_array_t:
+    {
+      const auto& l = get<float_array>(lhs);
+      const auto& r = get<float_array>(rhs);
+      return l.size() == r.size() && same_floats(l.data(), r.data(), l.size());
+    }
+    case Type::int_array_t:
+      return get<int_array>(lhs) == get<int_array>(rhs);
+    case Type::vec2f_t:
+      return same_floats(get<vec2f>(lhs).data(), get<vec2f>(rhs).data(), 2);
+    case Type::vec3f_t:
+      return same_floats(get<vec3f>(lhs).data(), get<vec3f>(rhs).data(), 3);
+    case Type::vec4f_t:
+      return same_floats(get<vec4f>(lhs).data(), get<vec4f>(rhs).data(), 4);
+    default:
+      return false;
+  }
+}
+
 struct RepetitionFilter
 {
     coppa_name(RepetitionFilter)
     bool repetitionFilter{};
 };
 
+// The higher, the sooner the values are sent when the output is congested
+// (e.g. transport and cues before meters).
+struct Priority
+{
+    coppa_name(Priority)
+    int32_t priority{};
+};
+
 template<typename ValueType> using Enum = std::vector<ValueType>;
 using Range = coppa::Range<Variant>;
 using Parameter = AttributeAggregate<
@@ -104,6 +202,7 @@ using Parameter = AttributeAggregate<
   Description,
   Access,
   Bounding,
-  RepetitionFilter>;
+  RepetitionFilter,
+  Priority>;
 }
 }
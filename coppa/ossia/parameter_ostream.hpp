@@ -39,6 +39,21 @@ inline std::ostream& operator <<(std::ostream& stream, const coppa::ossia::Varia
       void operator()(const Generic& ) const {
         s << "Generic ";
       }
+      void operator()(const float_array& val) const {
+        s << "FloatArray: " << val.size() << " ";
+      }
+      void operator()(const int_array& val) const {
+        s << "IntArray: " << val.size() << " ";
+      }
+      void operator()(const vec2f& val) const {
+        s << "Vec2f: " << val[0] << " " << val[1] << " ";
+      }
+      void operator()(const vec3f& val) const {
+        s << "Vec3f: " << val[0] << " " << val[1] << " " << val[2] << " ";
+      }
+      void operator()(const vec4f& val) const {
+        s << "Vec4f: " << val[0] << " " << val[1] << " " << val[2] << " " << val[3] << " ";
+      }
 
   } visitor{stream};
 
@@ -0,0 +1,199 @@
+#pragma once
+#include <oscpack/osc/OscTypes.h>
+#include <oscpack/osc/OscReceivedElements.h>
+#include <boost/endian/conversion.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX2__) || defined(__SSSE3__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace coppa
+{
+namespace osc
+{
+// Converts count big-endian 32-bit words from src to dst,
+// e.g. an array of int32_t or float. Neither needs to be aligned.
+inline void read_big_endian_32(const char* src, std::size_t count, void* dst_words)
+{
+  auto dst = static_cast<char*>(dst_words);
+  std::size_t i = 0;
+
+#if defined(__AVX2__)
+  const __m256i swap256 = _mm256_setr_epi8(
+        3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+        3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+  for(; i + 8 <= count; i += 8)
+  {
+    auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 4 * i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 4 * i), _mm256_shuffle_epi8(v, swap256));
+  }
+#endif
+
+#if defined(__SSSE3__)
+  const __m128i swap128 = _mm_setr_epi8(
+        3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+  for(; i + 4 <= count; i += 4)
+  {
+    auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 4 * i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 4 * i), _mm_shuffle_epi8(v, swap128));
+  }
+#elif defined(__ARM_NEON) && !defined(__ARM_BIG_ENDIAN)
+  for(; i + 4 <= count; i += 4)
+  {
+    auto v = vld1q_u8(reinterpret_cast<const uint8_t*>(src + 4 * i));
+    vst1q_u8(reinterpret_cast<uint8_t*>(dst + 4 * i), vrev32q_u8(v));
+  }
+#endif
+
+  for(; i < count; i++)
+  {
+    uint32_t word;
+    std::memcpy(&word, src + 4 * i, 4);
+    word = boost::endian::big_to_native(word);
+    std::memcpy(dst + 4 * i, &word, 4);
+  }
+}
+
+// Size of the data of an argument, padding included.
+inline std::size_t argument_size(char tag, const char* data)
+{
+  using namespace oscpack;
+  const auto padded = [] (std::size_t n) { return (n + 3) & ~std::size_t(3); };
+  switch(tag)
+  {
+    case INT32_TYPE_TAG:
+    case FLOAT_TYPE_TAG:
+    case CHAR_TYPE_TAG:
+    case RGBA_COLOR_TYPE_TAG:
+    case MIDI_MESSAGE_TYPE_TAG:
+      return 4;
+    case INT64_TYPE_TAG:
+    case TIME_TAG_TYPE_TAG:
+    case DOUBLE_TYPE_TAG:
+      return 8;
+    case STRING_TYPE_TAG:
+    case SYMBOL_TYPE_TAG:
+      return padded(std::strlen(data) + 1);
+    case BLOB_TYPE_TAG:
+    {
+      uint32_t size;
+      std::memcpy(&size, data, 4);
+      return 4 + padded(boost::endian::big_to_native(size));
+    }
+    default:
+      return 0;
+  }
+}
+
+/**
+ * @brief The argument_position struct
+ *
+ * Type tag and data of an argument in a received message.
+ * oscpack only gives access to the data through the typed accessors,
+ * which read one argument at a time.
+ */
+struct argument_position
+{
+    const char* tag{};
+    const char* data{};
+
+    void advance()
+    {
+      data += argument_size(*tag, data);
+      ++tag;
+    }
+};
+
+// Position of the first argument.
+inline argument_position arguments_begin(const oscpack::ReceivedMessage& m)
+{
+  // The type tags start with ',' and are padded with at least one zero.
+  const char* tags = m.TypeTags();
+  const std::size_t size = m.ArgumentCount() + 2;
+  return {tags, tags - 1 + ((size + 3) & ~std::size_t(3))};
+}
+
+// Position of the argument at it; linear in the index of the argument.
+inline argument_position locate(
+    const oscpack::ReceivedMessage& m,
+    oscpack::ReceivedMessageArgumentIterator it)
+{
+  auto pos = arguments_begin(m);
+  for(auto cur = m.ArgumentsBegin(), end = m.ArgumentsEnd(); cur != it && cur != end; ++cur)
+    pos.advance();
+  return pos;
+}
+
+// Number of consecutive int32 or float arguments with the same type tag.
+inline std::size_t numeric_run(const char* tag)
+{
+  const char c = *tag;
+  if(c != oscpack::INT32_TYPE_TAG && c != oscpack::FLOAT_TYPE_TAG)
+    return 0;
+
+  const char* end = tag;
+  while(*end == c)
+    ++end;
+  return std::size_t(end - tag);
+}
+
+// Below this, the arguments are read one by one.
+static const constexpr std::size_t bulk_threshold = 8;
+
+/**
+ * Decodes count int32 or float arguments (the run starting at pos)
+ * into variants[first], variants[first + 1], ...
+ * The variants are appended if they are too few.
+ */
+template<typename Variants>
+void read_numeric_run(
+    argument_position pos,
+    std::size_t count,
+    Variants& variants,
+    std::size_t first)
+{
+  const std::size_t size = variants.size();
+  if(size < first + count)
+    variants.reserve(first + count);
+
+  const auto store = [&] (std::size_t i, auto value) {
+    if(i < size)
+      variants[i] = value;
+    else
+      variants.emplace_back(value);
+  };
+
+  uint32_t words[256];
+  for(std::size_t done = 0; done < count; )
+  {
+    const auto n = std::min(count - done, sizeof(words) / sizeof(words[0]));
+    read_big_endian_32(pos.data + 4 * done, n, words);
+
+    const auto i = first + done;
+    if(*pos.tag == oscpack::FLOAT_TYPE_TAG)
+    {
+      for(std::size_t k = 0; k < n; k++)
+      {
+        float f;
+        std::memcpy(&f, &words[k], 4);
+        store(i + k, f);
+      }
+    }
+    else
+    {
+      for(std::size_t k = 0; k < n; k++)
+        store(i + k, int32_t(words[k]));
+    }
+
+    done += n;
+  }
+}
+
+}
+}
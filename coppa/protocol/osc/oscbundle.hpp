@@ -0,0 +1,73 @@
+#pragma once
+#include <oscpack/osc/OscTypes.h>
+#include <oscpack/osc/OscOutboundPacketStream.h>
+#include <string>
+#include <cstdint>
+
+namespace coppa
+{
+namespace osc
+{
+// Time tag meaning "process upon reception" in the OSC 1.0 spec.
+static constexpr const oscpack::uint64 immediate_time_tag = 1;
+
+/**
+ * @brief The bundle_writer class
+ *
+ * Builds an OSC bundle out of already serialized messages.
+ *
+ * oscpack::OutboundPacketStream can only serialize messages from their
+ * arguments; this allows to reuse a buffer that was encoded beforehand
+ * (e.g. kept by a sender until it is flushed) without a second encoding.
+ */
+class bundle_writer
+{
+  public:
+    bundle_writer(oscpack::uint64 time_tag = immediate_time_tag)
+    {
+      clear(time_tag);
+    }
+
+    void clear(oscpack::uint64 time_tag = immediate_time_tag)
+    {
+      m_buffer.assign("#bundle\0", 8);
+      for(int i = 7; i >= 0; i--)
+        m_buffer.push_back(char((time_tag >> (8 * i)) & 0xFF));
+      m_count = 0;
+    }
+
+    // Size of the bundle once an element of the given size is added.
+    std::size_t size_with(std::size_t message_size) const
+    { return m_buffer.size() + 4 + message_size; }
+
+    void add(const char* message, std::size_t size)
+    {
+      const auto n = static_cast<uint32_t>(size);
+      m_buffer.push_back(char((n >> 24) & 0xFF));
+      m_buffer.push_back(char((n >> 16) & 0xFF));
+      m_buffer.push_back(char((n >> 8) & 0xFF));
+      m_buffer.push_back(char(n & 0xFF));
+      m_buffer.append(message, size);
+      m_count++;
+    }
+
+    void add(const oscpack::OutboundPacketStream& p)
+    { add(p.Data(), p.Size()); }
+
+    bool empty() const
+    { return m_count == 0; }
+    std::size_t count() const
+    { return m_count; }
+
+    const char* data() const
+    { return m_buffer.data(); }
+    std::size_t size() const
+    { return m_buffer.size(); }
+
+  private:
+    std::string m_buffer;
+    std::size_t m_count = 0;
+};
+
+}
+}
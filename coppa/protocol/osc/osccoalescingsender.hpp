@@ -0,0 +1,457 @@
+#pragma once
+#include <coppa/protocol/osc/oscsender.hpp>
+#include <coppa/protocol/osc/oscbundle.hpp>
+#include <coppa/protocol/osc/oscmessagegenerator.hpp>
+#include <coppa/string_view.hpp>
+
+#include <boost/algorithm/string/predicate.hpp>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace coppa
+{
+namespace osc
+{
+enum class coalescing_mode
+{
+  Latest, // Only the last message sent to an address during a period is kept.
+  Bundle  // Every message is kept and they are all sent, in bundles.
+};
+
+/**
+ * @brief The coalescing_sender class
+ *
+ * Wraps a sender and delays the messages : for each address,
+ * the pending messages are kept and flushed at a fixed rate from
+ * a separate thread. All the addresses that are due at a given tick
+ * are packed in as few bundles as possible.
+ *
+ * The rate can be set for a whole subtree with set_rate, and the priority
+ * with set_priority : when the due messages do not fit in one packet,
+ * those of the higher priorities go in the first ones.
+ * For a same priority, the due messages are sent in the order
+ * of the calls to send, across all the addresses.
+ *
+ * It has the same interface than the sender it wraps, hence can be used as
+ * the DataProtocolSender of osc_local_device :
+ *
+ * osc_local_device<Map, osc::receiver, Handler, osc::coalescing_sender<>>
+ *
+ * Pending messages are flushed upon destruction so that the final state
+ * is not lost.
+ */
+template<typename Sender = coppa::osc::sender>
+class coalescing_sender
+{
+  public:
+    using clock = std::chrono::steady_clock;
+
+    coalescing_sender() = default;
+    coalescing_sender(coalescing_sender&&) = default;
+    coalescing_sender(const coalescing_sender&) = delete;
+    coalescing_sender& operator=(coalescing_sender&&) = default;
+    coalescing_sender& operator=(const coalescing_sender&) = delete;
+
+    coalescing_sender(
+        const std::string& ip,
+        const int port,
+        clock::duration period = std::chrono::milliseconds(10),
+        coalescing_mode mode = coalescing_mode::Latest):
+      m_impl{std::make_unique<impl>(Sender{ip, port}, period, mode)}
+    {
+    }
+
+    template<typename... Args>
+    void send(const std::string& address, Args&&... args)
+    {
+      oscpack::MessageGenerator<> gen;
+      const auto& p = gen(address, std::forward<Args>(args)...);
+      m_impl->push(string_view(address), p.Data(), p.Size());
+    }
+
+    template<typename... Args>
+    void send(string_view address, Args&&... args)
+    {
+      oscpack::MessageGenerator<> gen;
+      const auto& p = gen(address, std::forward<Args>(args)...);
+      m_impl->push(address, p.Data(), p.Size());
+    }
+
+    template<int N, typename... Args>
+    void send(oscpack::small_string_base<N> address, Args&&... args)
+    {
+      oscpack::MessageGenerator<> gen;
+      const auto& p = gen(address, std::forward<Args>(args)...);
+      m_impl->push(string_view(address.data()), p.Data(), p.Size());
+    }
+
+    // Sets the flush period of every address below subtree (included).
+    // The most specific subtree wins.
+    void set_rate(const std::string& subtree, clock::duration period)
+    { m_impl->set_rate(subtree, period); }
+
+    // Sets the priority of every address below subtree (included) ;
+    // the default is 0. The most specific subtree wins.
+    // The Priority of the parameters is not read : osc_local_device
+    // only forwards it from its own set_priority.
+    void set_priority(const std::string& subtree, int32_t priority)
+    { m_impl->set_priority(subtree, priority); }
+
+    void set_mode(coalescing_mode mode)
+    { m_impl->set_mode(mode); }
+
+    // Packets are split in multiple bundles above this size.
+    void set_max_packet_size(std::size_t size)
+    { m_impl->set_max_packet_size(size); }
+
+    // Sends everything that is pending right now.
+    void flush()
+    { m_impl->flush(); }
+
+    // Sends what is due at now.
+    // Called by the sender's thread ; public so that it can be driven by hand.
+    void tick(clock::time_point now)
+    { m_impl->tick(now); }
+
+    const std::string& ip() const { return m_impl->sender.ip(); }
+    int port() const { return m_impl->sender.port(); }
+
+  private:
+    struct pending_message
+    {
+        std::string data;
+        uint64_t sequence{}; // Order of the call to send
+    };
+
+    struct slot
+    {
+        clock::duration period{};
+        clock::time_point next_flush{};
+        int32_t priority{};
+
+        // Only the first "count" messages are pending;
+        // the others are kept to reuse their storage.
+        std::vector<pending_message> messages;
+        std::size_t count = 0;
+    };
+
+    struct rate_rule
+    {
+        std::string subtree;
+        clock::duration period;
+    };
+
+    struct priority_rule
+    {
+        std::string subtree;
+        int32_t priority;
+    };
+
+    struct impl
+    {
+        impl(Sender&& s, clock::duration period, coalescing_mode mode):
+          sender{std::move(s)},
+          m_defaultPeriod{period},
+          m_tick{period},
+          m_mode{mode}
+        {
+          m_thread = std::thread([this] { run(); });
+        }
+
+        ~impl()
+        {
+          {
+            std::lock_guard<std::mutex> l{m_mutex};
+            m_running = false;
+          }
+          m_cv.notify_one();
+          m_thread.join();
+
+          flush();
+        }
+
+        void push(string_view address, const char* data, std::size_t size)
+        {
+          std::lock_guard<std::mutex> l{m_mutex};
+          auto it = m_slots.find(address);
+          if(it == m_slots.end())
+          {
+            it = m_slots.emplace(address.to_string(), slot{}).first;
+            it->second.period = period_for(it->first);
+            it->second.priority = priority_for(it->first);
+          }
+
+          auto& s = it->second;
+          pending_message* message{};
+          if(m_mode == coalescing_mode::Latest && s.count > 0)
+          {
+            message = &s.messages.front();
+          }
+          else if(s.count < s.messages.size())
+          {
+            // Reuses the existing capacity
+            message = &s.messages[s.count++];
+          }
+          else
+          {
+            s.messages.emplace_back();
+            message = &s.messages.back();
+            s.count++;
+          }
+
+          message->data.assign(data, size);
+          message->sequence = m_sequence++;
+        }
+
+        // The thread is woken up so that it waits with the new tick
+        // and not until the end of the previous one.
+        void set_rate(const std::string& subtree, clock::duration period)
+        {
+          {
+            std::lock_guard<std::mutex> l{m_mutex};
+            auto it = std::find_if(m_rules.begin(), m_rules.end(), [&] (const auto& rule) {
+              return rule.subtree == subtree;
+            });
+            if(it != m_rules.end())
+              it->period = period;
+            else
+              m_rules.push_back({subtree, period});
+
+            // The shortest period : it may also get longer
+            // when the period of a rule is raised.
+            m_tick = m_defaultPeriod;
+            for(const auto& rule : m_rules)
+              m_tick = std::min(m_tick, rule.period);
+
+            for(auto& s : m_slots)
+              s.second.period = period_for(s.first);
+          }
+          m_cv.notify_one();
+        }
+
+        void set_priority(const std::string& subtree, int32_t priority)
+        {
+          std::lock_guard<std::mutex> l{m_mutex};
+          auto it = std::find_if(m_priorities.begin(), m_priorities.end(), [&] (const auto& rule) {
+            return rule.subtree == subtree;
+          });
+          if(it != m_priorities.end())
+            it->priority = priority;
+          else
+            m_priorities.push_back({subtree, priority});
+
+          for(auto& s : m_slots)
+            s.second.priority = priority_for(s.first);
+        }
+
+        void set_mode(coalescing_mode mode)
+        {
+          std::lock_guard<std::mutex> l{m_mutex};
+          m_mode = mode;
+
+          // Only the last message of each address stays pending.
+          if(mode == coalescing_mode::Latest)
+          {
+            for(auto& elt : m_slots)
+            {
+              auto& s = elt.second;
+              if(s.count > 1)
+              {
+                std::swap(s.messages.front(), s.messages[s.count - 1]);
+                s.count = 1;
+              }
+            }
+          }
+        }
+
+        void set_max_packet_size(std::size_t size)
+        {
+          std::lock_guard<std::mutex> l{m_mutex};
+          m_maxPacketSize = size;
+        }
+
+        void flush()
+        {
+          flush_impl(clock::now(), true);
+        }
+
+        void tick(clock::time_point now)
+        {
+          flush_impl(now, false);
+        }
+
+        Sender sender;
+
+      private:
+        static bool in_subtree(const std::string& address, const std::string& subtree)
+        {
+          if(!boost::starts_with(address, subtree))
+            return false;
+          return address.size() == subtree.size()
+              || subtree.back() == '/'
+              || address[subtree.size()] == '/';
+        }
+
+        clock::duration period_for(const std::string& address) const
+        {
+          auto period = m_defaultPeriod;
+          std::size_t best = 0;
+          for(const auto& rule : m_rules)
+          {
+            if(rule.subtree.size() >= best && in_subtree(address, rule.subtree))
+            {
+              best = rule.subtree.size();
+              period = rule.period;
+            }
+          }
+          return period;
+        }
+
+        int32_t priority_for(const std::string& address) const
+        {
+          int32_t priority = 0;
+          std::size_t best = 0;
+          for(const auto& rule : m_priorities)
+          {
+            if(rule.subtree.size() >= best && in_subtree(address, rule.subtree))
+            {
+              best = rule.subtree.size();
+              priority = rule.priority;
+            }
+          }
+          return priority;
+        }
+
+        // Packs the due messages into bundles, by decreasing priority
+        // then in the order they were sent; requires both locks.
+        void prepare(clock::time_point now, bool force)
+        {
+          m_packetCount = 0;
+          m_due.clear();
+          m_dueMessages.clear();
+          for(auto& elt : m_slots)
+          {
+            auto& s = elt.second;
+            if(s.count == 0 || (!force && s.next_flush > now))
+              continue;
+            m_due.push_back(&s);
+            for(std::size_t i = 0; i < s.count; i++)
+              m_dueMessages.push_back({s.priority, &s.messages[i]});
+          }
+
+          std::sort(m_dueMessages.begin(), m_dueMessages.end(), [] (const due_message& lhs, const due_message& rhs) {
+            if(lhs.priority != rhs.priority)
+              return lhs.priority > rhs.priority;
+            return lhs.message->sequence < rhs.message->sequence;
+          });
+
+          for(const auto& due : m_dueMessages)
+          {
+            const auto& message = due.message->data;
+            if(m_packetCount == 0
+            || (!current_packet().empty()
+                && current_packet().size_with(message.size()) > m_maxPacketSize))
+            {
+              next_packet();
+            }
+            current_packet().add(message.data(), message.size());
+          }
+
+          for(auto sp : m_due)
+          {
+            sp->count = 0;
+            sp->next_flush = now + sp->period;
+          }
+        }
+
+        // The packets are sent without holding the lock on the slots
+        // so that the producers are not blocked by the socket.
+        void flush_impl(clock::time_point now, bool force)
+        {
+          std::lock_guard<std::mutex> send_lock{m_sendMutex};
+          std::unique_lock<std::mutex> l{m_mutex};
+          prepare(now, force);
+          l.unlock();
+
+          for(std::size_t i = 0; i < m_packetCount; i++)
+          {
+            const auto& packet = m_packets[i];
+            if(packet.count() == 1)
+            {
+              // No need for a bundle : "#bundle" + time tag + element size.
+              sender.send_raw(packet.data() + 20, packet.size() - 20);
+            }
+            else
+            {
+              sender.send_raw(packet.data(), packet.size());
+            }
+          }
+          m_packetCount = 0;
+        }
+
+        bundle_writer& current_packet()
+        { return m_packets[m_packetCount - 1]; }
+
+        void next_packet()
+        {
+          if(m_packetCount == m_packets.size())
+            m_packets.emplace_back();
+          else
+            m_packets[m_packetCount].clear();
+          m_packetCount++;
+        }
+
+        void run()
+        {
+          std::unique_lock<std::mutex> l{m_mutex};
+          while(m_running)
+          {
+            m_cv.wait_for(l, m_tick);
+            if(!m_running)
+              break;
+
+            l.unlock();
+            tick(clock::now());
+            l.lock();
+          }
+        }
+
+        std::map<std::string, slot, std::less<>> m_slots;
+        std::vector<rate_rule> m_rules;
+        std::vector<priority_rule> m_priorities;
+        struct due_message
+        {
+            int32_t priority;
+            const pending_message* message;
+        };
+
+        std::vector<slot*> m_due;
+        std::vector<due_message> m_dueMessages;
+        uint64_t m_sequence = 0;
+        clock::duration m_defaultPeriod{};
+        clock::duration m_tick{};
+        coalescing_mode m_mode{};
+        std::size_t m_maxPacketSize = 1472; // Fits in an Ethernet frame
+
+        std::vector<bundle_writer> m_packets;
+        std::size_t m_packetCount = 0;
+
+        bool m_running = true;
+        std::mutex m_mutex;
+        std::mutex m_sendMutex;
+        std::condition_variable m_cv;
+        std::thread m_thread;
+    };
+
+    std::unique_ptr<impl> m_impl;
+};
+
+}
+}
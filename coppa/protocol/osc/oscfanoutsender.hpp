@@ -0,0 +1,298 @@
+#pragma once
+#include <coppa/protocol/osc/oscmessagegenerator.hpp>
+#include <coppa/string_view.hpp>
+
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+namespace coppa
+{
+namespace osc
+{
+/**
+ * @brief The fanout_sender class
+ *
+ * Sends the same OSC packets to many UDP endpoints.
+ * A message is serialized once; the resulting buffer is then sent to every
+ * endpoint, in batches with sendmmsg on Linux.
+ *
+ * The endpoints are kept in a fixed-size array of atomic slots, so that
+ * add_endpoint / remove_endpoint can be called from any thread while
+ * other threads are sending, without locking.
+ *
+ * Multicast groups can be used as endpoints (see set_multicast_options)
+ * to reach a whole LAN with a single datagram.
+ *
+ * Only IPv4 is supported, like oscpack::IpEndpointName.
+ * Host names are resolved when the endpoint is added or removed.
+ */
+class fanout_sender
+{
+  public:
+    fanout_sender(std::size_t max_endpoints = 64):
+      m_endpoints{std::make_unique<std::atomic<uint64_t>[]>(max_endpoints)},
+      m_capacity{max_endpoints}
+    {
+      for(std::size_t i = 0; i < m_capacity; i++)
+        m_endpoints[i].store(0, std::memory_order_relaxed);
+
+      m_socket = ::socket(AF_INET, SOCK_DGRAM, 0);
+      if(m_socket < 0)
+        throw std::runtime_error("fanout_sender: unable to create socket");
+    }
+
+    fanout_sender(const fanout_sender&) = delete;
+    fanout_sender& operator=(const fanout_sender&) = delete;
+
+    ~fanout_sender()
+    {
+      ::close(m_socket);
+    }
+
+    // Returns false if the endpoint is invalid or there is no free slot.
+    bool add_endpoint(const std::string& ip, int port)
+    {
+      auto key = make_key(ip, port);
+      if(key == 0)
+        return false;
+
+      // Already here ?
+      const auto n = m_used.load(std::memory_order_acquire);
+      for(std::size_t i = 0; i < n; i++)
+      {
+        if(m_endpoints[i].load(std::memory_order_acquire) == key)
+          return true;
+      }
+
+      for(std::size_t i = 0; i < m_capacity; i++)
+      {
+        uint64_t expected = 0;
+        if(m_endpoints[i].compare_exchange_strong(expected, key))
+        {
+          // Grow the range of slots that the senders look at
+          auto used = m_used.load();
+          while(used < i + 1 && !m_used.compare_exchange_weak(used, i + 1))
+          { }
+
+          remove_duplicates(key, i);
+          return true;
+        }
+      }
+
+      return false;
+    }
+
+    bool remove_endpoint(const std::string& ip, int port)
+    {
+      auto key = make_key(ip, port);
+      if(key == 0)
+        return false;
+
+      const auto n = m_used.load(std::memory_order_acquire);
+      for(std::size_t i = 0; i < n; i++)
+      {
+        uint64_t expected = key;
+        if(m_endpoints[i].compare_exchange_strong(expected, 0))
+          return true;
+      }
+
+      return false;
+    }
+
+    void clear_endpoints()
+    {
+      for(std::size_t i = 0; i < m_capacity; i++)
+        m_endpoints[i].store(0);
+    }
+
+    std::size_t endpoint_count() const
+    {
+      std::size_t count = 0;
+      const auto n = m_used.load(std::memory_order_acquire);
+      for(std::size_t i = 0; i < n; i++)
+      {
+        if(m_endpoints[i].load(std::memory_order_relaxed) != 0)
+          count++;
+      }
+      return count;
+    }
+
+    // ttl : 1 keeps the packets on the local network.
+    // loopback : whether the packets are also received on this host.
+    void set_multicast_options(int ttl, bool loopback)
+    {
+      unsigned char t = static_cast<unsigned char>(ttl);
+      unsigned char l = loopback ? 1 : 0;
+      ::setsockopt(m_socket, IPPROTO_IP, IP_MULTICAST_TTL, &t, sizeof(t));
+      ::setsockopt(m_socket, IPPROTO_IP, IP_MULTICAST_LOOP, &l, sizeof(l));
+    }
+
+    template<typename... Args>
+    void send(const std::string& address, Args&&... args)
+    {
+      send_packet(oscpack::MessageGenerator<>{}(
+                  address,
+                  std::forward<Args>(args)...));
+    }
+
+    template<typename... Args>
+    void send(string_view address, Args&&... args)
+    {
+      send_packet(oscpack::MessageGenerator<>{}(
+                  address,
+                  std::forward<Args>(args)...));
+    }
+
+    template<int N, typename... Args>
+    void send(oscpack::small_string_base<N> address, Args&&... args)
+    {
+      send_packet(oscpack::MessageGenerator<>{}(
+                  address,
+                  std::forward<Args>(args)...));
+    }
+
+    void send_packet(const oscpack::OutboundPacketStream& p)
+    {
+      send_raw(p.Data(), p.Size());
+    }
+
+    // Sends an already serialized packet to every endpoint.
+    void send_raw(const char* data, std::size_t size)
+    {
+      sockaddr_in addresses[batch_size];
+      std::size_t count = 0;
+
+      const auto n = m_used.load(std::memory_order_acquire);
+      for(std::size_t i = 0; i < n; i++)
+      {
+        auto key = m_endpoints[i].load(std::memory_order_acquire);
+        if(key == 0)
+          continue;
+
+        auto& addr = addresses[count];
+        addr = sockaddr_in{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = static_cast<uint32_t>(key >> 16);
+        addr.sin_port = static_cast<uint16_t>(key & 0xFFFF);
+
+        if(++count == batch_size)
+        {
+          flush_batch(data, size, addresses, count);
+          count = 0;
+        }
+      }
+
+      if(count > 0)
+        flush_batch(data, size, addresses, count);
+    }
+
+  private:
+    static const constexpr std::size_t batch_size = 64;
+
+    // Another thread may have added the same endpoint in another slot
+    // at the same time : only the one in the first slot is kept.
+    // Both threads look at all the slots after their own insertion,
+    // so at least one of them sees the other.
+    void remove_duplicates(uint64_t key, std::size_t slot)
+    {
+      const auto n = m_used.load();
+      for(std::size_t i = 0; i < n; i++)
+      {
+        if(i == slot || m_endpoints[i].load() != key)
+          continue;
+
+        if(i < slot)
+        {
+          uint64_t expected = key;
+          m_endpoints[slot].compare_exchange_strong(expected, 0);
+          return;
+        }
+
+        uint64_t expected = key;
+        m_endpoints[i].compare_exchange_strong(expected, 0);
+      }
+    }
+
+    void flush_batch(
+        const char* data,
+        std::size_t size,
+        sockaddr_in* addresses,
+        std::size_t count)
+    {
+#if defined(__linux__)
+      // All the messages share the same payload.
+      iovec iov{const_cast<char*>(data), size};
+      mmsghdr messages[batch_size];
+      for(std::size_t i = 0; i < count; i++)
+      {
+        messages[i] = mmsghdr{};
+        messages[i].msg_hdr.msg_name = &addresses[i];
+        messages[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+        messages[i].msg_hdr.msg_iov = &iov;
+        messages[i].msg_hdr.msg_iovlen = 1;
+      }
+
+      std::size_t sent = 0;
+      while(sent < count)
+      {
+        int res = ::sendmmsg(m_socket, messages + sent, count - sent, 0);
+        if(res <= 0)
+          break; // Like UDP, packets that cannot be sent are dropped.
+        sent += res;
+      }
+#else
+      for(std::size_t i = 0; i < count; i++)
+      {
+        ::sendto(m_socket, data, size, 0,
+                 reinterpret_cast<const sockaddr*>(&addresses[i]),
+                 sizeof(sockaddr_in));
+      }
+#endif
+    }
+
+    // Address in network order in bits 16..47, port in network order in
+    // bits 0..15, and a bit set at 48 so that a valid endpoint is never 0.
+    static uint64_t make_key(const std::string& ip, int port)
+    {
+      if(port <= 0 || port > 65535)
+        return 0;
+      in_addr addr{};
+      if(::inet_pton(AF_INET, ip.c_str(), &addr) != 1 && !resolve(ip, addr))
+        return 0;
+
+      return (uint64_t(1) << 48)
+          | (uint64_t(addr.s_addr) << 16)
+          | uint64_t(htons(static_cast<uint16_t>(port)));
+    }
+
+    static bool resolve(const std::string& host, in_addr& addr)
+    {
+      addrinfo hints{};
+      hints.ai_family = AF_INET;
+      hints.ai_socktype = SOCK_DGRAM;
+
+      addrinfo* res{};
+      if(::getaddrinfo(host.c_str(), nullptr, &hints, &res) != 0 || !res)
+        return false;
+
+      addr = reinterpret_cast<const sockaddr_in*>(res->ai_addr)->sin_addr;
+      ::freeaddrinfo(res);
+      return true;
+    }
+
+    std::unique_ptr<std::atomic<uint64_t>[]> m_endpoints;
+    std::size_t m_capacity{};
+    std::atomic<std::size_t> m_used{0};
+    int m_socket = -1;
+};
+
+}
+}
@@ -3,6 +3,8 @@
 #include <oscpack/osc/OscOutboundPacketStream.h>
 #include <coppa/minuit/osc/osc.hpp>
 #include <array>
+#include <memory>
+#include <vector>
 #include <boost/container/small_vector.hpp>
 #include <coppa/string_view.hpp>
 
@@ -104,4 +106,46 @@ class MessageGenerator
     alignas(128) std::array<char, BufferSize> buffer;
     oscpack::OutboundPacketStream p{buffer.data(), buffer.size()};
 };
+
+/**
+ * @brief The DynamicMessageGenerator class
+ *
+ * Like MessageGenerator, but the buffer is allocated on the heap
+ * and grows until the message fits.
+ * For the transports that are not limited by the size of a datagram.
+ */
+class DynamicMessageGenerator
+{
+  public:
+    DynamicMessageGenerator(std::size_t size = 65536):
+      buffer(size)
+    {
+    }
+
+    template<typename Name, typename... T>
+    const oscpack::OutboundPacketStream& operator()(
+        const Name& name,
+        const T&... args)
+    {
+      while(true)
+      {
+        try
+        {
+          p = std::make_unique<oscpack::OutboundPacketStream>(buffer.data(), buffer.size());
+          *p << oscpack::BeginMessageN( name );
+          (void) std::initializer_list<int>{(*p << args, 0)...};
+          *p << oscpack::EndMessage();
+          return *p;
+        }
+        catch(const oscpack::OutOfBufferMemoryException&)
+        {
+          buffer.resize(buffer.size() * 2);
+        }
+      }
+    }
+
+  private:
+    std::vector<char> buffer;
+    std::unique_ptr<oscpack::OutboundPacketStream> p;
+};
 }
@@ -2,6 +2,7 @@
 #include <oscpack/osc/OscDebug.h>
 #include <oscpack/ip/UdpSocket.h>
 #include <oscpack/osc/OscPacketListener.h>
+#include <cstring>
 #include <memory>
 #include <thread>
 #include <functional>
@@ -46,6 +47,49 @@ class listener: public oscpack::OscPacketListener
     MessageHandler m_messageHandler;
 };
 
+/**
+ * @brief The bundle_listener class
+ *
+ * Like listener, but the bundles are not split in messages :
+ * they are passed whole to the bundle handler, with their time tag,
+ * e.g. to a bundle_scheduler.
+ */
+template<typename MessageHandler, typename BundleHandler>
+class bundle_listener: public listener<MessageHandler>
+{
+  public:
+    bundle_listener(MessageHandler msg, BundleHandler bundle):
+      listener<MessageHandler>{msg},
+      m_bundleHandler{bundle}
+    {
+    }
+
+    void ProcessPacket(
+        const char* data,
+        int size,
+        const oscpack::IpEndpointName& ip) override
+    {
+      if(size >= 16 && std::memcmp(data, "#bundle", 8) == 0)
+      {
+        try
+        {
+          m_bundleHandler(data, std::size_t(size), ip);
+        }
+        catch( std::exception& e )
+        {
+          std::cerr << "OSC Bundle Error: " << e.what() << std::endl;
+        }
+      }
+      else
+      {
+        listener<MessageHandler>::ProcessPacket(data, size, ip);
+      }
+    }
+
+  private:
+    BundleHandler m_bundleHandler;
+};
+
 /**
  * @brief The receiver class
  *
@@ -70,6 +114,14 @@ class receiver
       setPort(port);
     }
 
+    // The bundles are passed to bundle, see bundle_listener.
+    template<typename Handler, typename BundleHandler>
+    receiver(unsigned int port, Handler msg, BundleHandler bundle):
+      m_impl{std::make_unique<bundle_listener<Handler, BundleHandler> >(msg, bundle)}
+    {
+      setPort(port);
+    }
+
     receiver& operator=(receiver&& other)
     {
       stop();
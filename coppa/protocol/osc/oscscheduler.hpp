@@ -0,0 +1,201 @@
+#pragma once
+#include <coppa/protocol/osc/oscbundle.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace coppa
+{
+namespace osc
+{
+// Seconds between 1900 (NTP epoch, used by OSC time tags) and 1970.
+static constexpr const uint64_t ntp_epoch_offset = 2208988800ULL;
+
+inline std::chrono::system_clock::time_point to_time_point(uint64_t time_tag)
+{
+  using namespace std::chrono;
+  if((time_tag >> 32) < ntp_epoch_offset)
+    return system_clock::time_point{};
+
+  const auto seconds = (time_tag >> 32) - ntp_epoch_offset;
+  const auto fraction = (time_tag & 0xFFFFFFFFULL) * 1000000000ULL >> 32;
+  return system_clock::time_point{
+        duration_cast<system_clock::duration>(
+          std::chrono::seconds(seconds) + nanoseconds(fraction))};
+}
+
+inline uint64_t to_time_tag(std::chrono::system_clock::time_point t)
+{
+  using namespace std::chrono;
+  const auto ns = duration_cast<nanoseconds>(t.time_since_epoch()).count();
+  const uint64_t seconds = ns / 1000000000ULL + ntp_epoch_offset;
+  const uint64_t fraction = (uint64_t(ns % 1000000000ULL) << 32) / 1000000000ULL;
+  return (seconds << 32) | fraction;
+}
+
+enum class late_bundle_policy
+{
+  Apply, // Bundles whose time has passed are applied upon reception.
+  Drop   // Bundles whose time has passed are ignored.
+};
+
+/**
+ * @brief The bundle_scheduler class
+ *
+ * Keeps the received OSC bundles until the time of their time tag.
+ * Bundles are kept in a min-heap ordered by time tag; a thread
+ * waits for the next one and passes it to the apply function, whole,
+ * so that all its messages can be applied at once.
+ * Bundles with the same time tag are applied in the order of reception.
+ *
+ * Bundles tagged "immediately" are applied in the calling thread,
+ * as are late bundles unless the late policy is Drop.
+ * The thread is only started when a bundle in the future is received.
+ */
+class bundle_scheduler
+{
+  public:
+    using clock = std::chrono::system_clock;
+    using apply_fun = std::function<void(const char*, std::size_t)>;
+
+    bundle_scheduler() = default;
+    bundle_scheduler(apply_fun f):
+      m_apply{std::move(f)}
+    {
+    }
+
+    ~bundle_scheduler()
+    {
+      {
+        std::lock_guard<std::mutex> l{m_mutex};
+        m_running = false;
+      }
+      m_cv.notify_one();
+      if(m_thread.joinable())
+        m_thread.join();
+    }
+
+    void set_late_policy(late_bundle_policy p)
+    {
+      std::lock_guard<std::mutex> l{m_mutex};
+      m_policy = p;
+    }
+
+    // data must be a bundle.
+    void schedule(const char* data, std::size_t size)
+    {
+      if(size < 16)
+        return;
+
+      const auto tag = read_time_tag(data);
+      if(tag == immediate_time_tag)
+      {
+        m_apply(data, size);
+        return;
+      }
+
+      const auto due = to_time_point(tag);
+      std::unique_lock<std::mutex> l{m_mutex};
+      if(due <= clock::now())
+      {
+        const auto policy = m_policy;
+        l.unlock();
+
+        if(policy == late_bundle_policy::Apply)
+          m_apply(data, size);
+        return;
+      }
+
+      m_queue.push_back({due, m_order++, std::string(data, size)});
+      std::push_heap(m_queue.begin(), m_queue.end(), later{});
+
+      if(!m_thread.joinable())
+        m_thread = std::thread([this] { run(); });
+
+      // Only needed if the new bundle is the next one
+      const bool first = m_queue.front().order == m_order - 1;
+      l.unlock();
+      if(first)
+        m_cv.notify_one();
+    }
+
+    std::size_t pending() const
+    {
+      std::lock_guard<std::mutex> l{m_mutex};
+      return m_queue.size();
+    }
+
+  private:
+    struct entry
+    {
+        clock::time_point due;
+        uint64_t order;
+        std::string data;
+    };
+
+    struct later
+    {
+        bool operator()(const entry& lhs, const entry& rhs) const
+        {
+          return lhs.due > rhs.due
+              || (lhs.due == rhs.due && lhs.order > rhs.order);
+        }
+    };
+
+    static uint64_t read_time_tag(const char* data)
+    {
+      auto u = reinterpret_cast<const unsigned char*>(data + 8);
+      uint64_t tag = 0;
+      for(int i = 0; i < 8; i++)
+        tag = (tag << 8) | u[i];
+      return tag;
+    }
+
+    void run()
+    {
+      std::unique_lock<std::mutex> l{m_mutex};
+      while(m_running)
+      {
+        if(m_queue.empty())
+        {
+          m_cv.wait(l);
+          continue;
+        }
+
+        const auto due = m_queue.front().due;
+        if(clock::now() < due)
+        {
+          m_cv.wait_until(l, due);
+          continue;
+        }
+
+        std::pop_heap(m_queue.begin(), m_queue.end(), later{});
+        auto e = std::move(m_queue.back());
+        m_queue.pop_back();
+
+        l.unlock();
+        m_apply(e.data.data(), e.data.size());
+        l.lock();
+      }
+    }
+
+    apply_fun m_apply;
+    std::vector<entry> m_queue;
+    uint64_t m_order = 0;
+    late_bundle_policy m_policy = late_bundle_policy::Apply;
+
+    bool m_running = true;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::thread m_thread;
+};
+
+}
+}
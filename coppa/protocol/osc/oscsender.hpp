@@ -59,6 +59,12 @@ class sender
     }
 
 
+    // Sends an already serialized packet (message or bundle).
+    void send_raw(const char* data, std::size_t size)
+    {
+      m_socket->Send(data, size);
+    }
+
     const std::string& ip() const { return m_ip; }
     int port() const { return m_port; }
 
@@ -0,0 +1,137 @@
+#pragma once
+#include <coppa/protocol/osc/oscreceiver.hpp>
+#include <coppa/protocol/osc/oscshmring.hpp>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+namespace coppa
+{
+namespace osc
+{
+/**
+ * @brief The shm_receiver class
+ *
+ * A OSC server for the processes of the same host,
+ * with the same interface as coppa::osc::receiver.
+ * The packets are read from a shared memory segment named after the port.
+ *
+ * Note : if a port cannot be opened, it will be incremented.
+ */
+class shm_receiver
+{
+  public:
+    shm_receiver() = default;
+    shm_receiver(shm_receiver&&) = default;
+    shm_receiver& operator=(shm_receiver&&) = default;
+
+    template<typename Handler>
+    shm_receiver(
+        unsigned int port,
+        Handler msg,
+        uint32_t slot_count = shm_ring::default_slot_count,
+        uint32_t slot_size = shm_ring::default_slot_size):
+      m_impl{std::make_unique<impl>(std::make_unique<listener<Handler>>(msg))}
+    {
+      m_impl->slot_count = slot_count;
+      m_impl->slot_size = slot_size;
+      setPort(port);
+    }
+
+    ~shm_receiver()
+    {
+      stop();
+    }
+
+    void run()
+    {
+      stop();
+      m_impl->running = true;
+      m_impl->thread = std::thread([impl = m_impl.get()] { impl->run(); });
+    }
+
+    void stop()
+    {
+      if(!m_impl)
+        return;
+
+      m_impl->running = false;
+      if(m_impl->thread.joinable())
+        m_impl->thread.join();
+    }
+
+    unsigned int port() const
+    {
+      return m_impl->port;
+    }
+
+    unsigned int setPort(unsigned int port)
+    {
+      const bool was_running = m_impl->running;
+      stop();
+
+      m_impl->port = port;
+      while(!m_impl->ring.create(shm_ring::segment_name(m_impl->port),
+                                 m_impl->slot_count,
+                                 m_impl->slot_size))
+      {
+        m_impl->port++;
+      }
+
+      if(was_running)
+        run();
+      return m_impl->port;
+    }
+
+  private:
+    struct impl
+    {
+        impl(std::unique_ptr<oscpack::OscPacketListener> l):
+          packet_listener{std::move(l)}
+        {
+        }
+
+        ~impl()
+        {
+          running = false;
+          if(thread.joinable())
+            thread.join();
+        }
+
+        void run()
+        {
+          const oscpack::IpEndpointName localhost{0x7F000001UL, 0};
+          while(running)
+          {
+            while(ring.pop([&] (const char* data, std::size_t size) {
+              try
+              {
+                packet_listener->ProcessPacket(data, static_cast<int>(size), localhost);
+              }
+              catch(std::exception& e)
+              {
+                std::cerr << "OSC Parse Error: " << e.what() << std::endl;
+              }
+            }))
+            { }
+
+            ring.wait(std::chrono::milliseconds(50));
+          }
+        }
+
+        std::unique_ptr<oscpack::OscPacketListener> packet_listener;
+        shm_ring ring;
+        unsigned int port = 0;
+        uint32_t slot_count{};
+        uint32_t slot_size{};
+
+        std::atomic_bool running{false};
+        std::thread thread;
+    };
+
+    std::unique_ptr<impl> m_impl;
+};
+
+}
+}
@@ -0,0 +1,422 @@
+#pragma once
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string>
+#include <thread>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#endif
+
+namespace coppa
+{
+namespace osc
+{
+/**
+ * @brief The shm_ring class
+ *
+ * A bounded queue of packets in a POSIX shared memory segment,
+ * for communication between processes on the same host.
+ *
+ * Any number of processes can push (lock-free, Vyukov's bounded queue);
+ * a single one, the owner of the segment, can pop.
+ * Each slot holds a packet of at most slot_size bytes.
+ *
+ * The reader only sleeps (on a futex on Linux) when the queue has been
+ * empty for a while, and the writers only make a system call to wake
+ * it up when it sleeps : under load, no system call is made.
+ */
+class shm_ring
+{
+  public:
+    static constexpr const uint32_t default_slot_count = 1024;
+    static constexpr const uint32_t default_slot_size = 2048;
+
+    shm_ring() = default;
+    shm_ring(const shm_ring&) = delete;
+    shm_ring& operator=(const shm_ring&) = delete;
+    shm_ring(shm_ring&& other) noexcept
+    {
+      *this = std::move(other);
+    }
+
+    shm_ring& operator=(shm_ring&& other) noexcept
+    {
+      close();
+      std::swap(m_name, other.m_name);
+      std::swap(m_header, other.m_header);
+      std::swap(m_mapSize, other.m_mapSize);
+      std::swap(m_inode, other.m_inode);
+      std::swap(m_device, other.m_device);
+      std::swap(m_owner, other.m_owner);
+      return *this;
+    }
+
+    ~shm_ring()
+    {
+      close();
+    }
+
+    // Name of the segment used for a given port.
+    static std::string segment_name(unsigned int port)
+    {
+      return "/coppa.osc." + std::to_string(port);
+    }
+
+    // Creates the segment; fails if it is in use by a running process.
+    // A segment left by a process that does not exist anymore is reused.
+    bool create(
+        const std::string& name,
+        uint32_t slot_count = default_slot_count,
+        uint32_t slot_size = default_slot_size)
+    {
+      close();
+
+      // The slot count must be a power of two
+      uint32_t count = 1;
+      while(count < slot_count)
+        count *= 2;
+
+      int fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+      if(fd < 0 && errno == EEXIST && reclaim(name))
+        fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+      if(fd < 0)
+        return false;
+
+      const auto stride = slot_stride(slot_size);
+      const auto size = sizeof(header) + std::size_t(count) * stride;
+      if(::ftruncate(fd, size) < 0 || !map(fd, size) || !identify(fd))
+      {
+        if(m_header)
+          unmap();
+        ::close(fd);
+        ::shm_unlink(name.c_str());
+        return false;
+      }
+      ::close(fd);
+
+      auto h = new(m_header) header;
+      h->slot_count = count;
+      h->slot_size = slot_size;
+      h->owner = ::getpid();
+      for(uint32_t i = 0; i < count; i++)
+        new(slot_at(i)) slot_header{i};
+
+      // Writers only use the segment once it is initialized.
+      h->magic.store(header::magic_value, std::memory_order_release);
+
+      m_name = name;
+      m_owner = true;
+      return true;
+    }
+
+    // Opens a segment created by another process.
+    bool open(const std::string& name)
+    {
+      close();
+
+      int fd = ::shm_open(name.c_str(), O_RDWR, 0600);
+      if(fd < 0)
+        return false;
+
+      struct stat st;
+      if(::fstat(fd, &st) < 0
+      || std::size_t(st.st_size) < sizeof(header)
+      || !map(fd, st.st_size))
+      {
+        ::close(fd);
+        return false;
+      }
+      ::close(fd);
+      m_inode = st.st_ino;
+      m_device = st.st_dev;
+
+      if(m_header->magic.load(std::memory_order_acquire) != header::magic_value
+      || m_mapSize < sizeof(header) + std::size_t(m_header->slot_count) * slot_stride(m_header->slot_size))
+      {
+        unmap();
+        return false;
+      }
+
+      m_name = name;
+      return true;
+    }
+
+    void close()
+    {
+      if(!m_header)
+        return;
+
+      if(m_owner)
+      {
+        // Lets the writers know that they must reopen the segment.
+        m_header->closed.store(1, std::memory_order_release);
+        ::shm_unlink(m_name.c_str());
+      }
+      unmap();
+      m_owner = false;
+      m_name.clear();
+    }
+
+    bool valid() const
+    { return m_header && !m_header->closed.load(std::memory_order_acquire); }
+
+    // For the writers : true if nobody will read the segment anymore,
+    // i.e. its owner closed it or stopped without closing it,
+    // or its name now refers to another segment, e.g. the one of
+    // a restarted owner. Makes system calls.
+    bool stale() const
+    {
+      if(!m_header)
+        return false;
+      if(m_header->closed.load(std::memory_order_acquire))
+        return true;
+      if(::kill(m_header->owner, 0) < 0 && errno == ESRCH)
+        return true;
+
+      int fd = ::shm_open(m_name.c_str(), O_RDONLY, 0600);
+      if(fd < 0)
+        return true;
+
+      struct stat st;
+      const bool same = ::fstat(fd, &st) == 0
+                     && st.st_ino == m_inode
+                     && st.st_dev == m_device;
+      ::close(fd);
+      return !same;
+    }
+
+    uint32_t slot_size() const
+    { return m_header->slot_size; }
+
+    // Returns false if the packet is too big or the queue is full;
+    // the packet is then dropped, like with UDP.
+    bool push(const char* data, std::size_t size)
+    {
+      auto& h = *m_header;
+      if(size > h.slot_size)
+        return false;
+
+      const uint64_t mask = h.slot_count - 1;
+      uint64_t pos = h.enqueue_pos.load(std::memory_order_relaxed);
+      slot_header* slot{};
+      while(true)
+      {
+        slot = slot_at(pos & mask);
+        const auto seq = slot->sequence.load(std::memory_order_acquire);
+        const auto diff = int64_t(seq) - int64_t(pos);
+        if(diff == 0)
+        {
+          if(h.enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            break;
+        }
+        else if(diff < 0)
+        {
+          return false;
+        }
+        else
+        {
+          pos = h.enqueue_pos.load(std::memory_order_relaxed);
+        }
+      }
+
+      std::memcpy(slot + 1, data, size);
+      slot->size = static_cast<uint32_t>(size);
+      slot->sequence.store(pos + 1, std::memory_order_release);
+
+      // Pairs with the fence in wait() : either the reader sees the packet,
+      // or the writer sees that the reader sleeps.
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if(h.sleeping.load())
+      {
+        h.futex.fetch_add(1);
+        wake(h.futex);
+      }
+      return true;
+    }
+
+    // For the owner only.
+    // Calls f(const char*, std::size_t) on the next packet if there is one.
+    // The packet is read in place.
+    template<typename Fun>
+    bool pop(Fun&& f)
+    {
+      auto& h = *m_header;
+      const uint64_t mask = h.slot_count - 1;
+      const auto pos = h.dequeue_pos.load(std::memory_order_relaxed);
+      auto slot = slot_at(pos & mask);
+      if(slot->sequence.load(std::memory_order_acquire) != pos + 1)
+        return false;
+
+      h.dequeue_pos.store(pos + 1, std::memory_order_relaxed);
+
+      // The slot is only given back to the writers after the callback
+      struct release_slot
+      {
+          slot_header* s;
+          uint64_t seq;
+          ~release_slot() { s->sequence.store(seq, std::memory_order_release); }
+      } release{slot, pos + mask + 1};
+
+      f(reinterpret_cast<const char*>(slot + 1), std::size_t(slot->size));
+      return true;
+    }
+
+    // For the owner only.
+    // Waits until a packet is pushed, or the timeout expires.
+    void wait(std::chrono::milliseconds timeout)
+    {
+      auto& h = *m_header;
+
+      // Short busy wait first, the next packet is often close.
+      for(int i = 0; i < 256; i++)
+      {
+        if(!empty())
+          return;
+        std::this_thread::yield();
+      }
+
+      const auto v = h.futex.load();
+      h.sleeping.store(1);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if(empty())
+        sleep(h.futex, v, timeout);
+      h.sleeping.store(0);
+    }
+
+    bool empty() const
+    {
+      auto& h = *m_header;
+      const auto pos = h.dequeue_pos.load(std::memory_order_relaxed);
+      auto slot = slot_at(pos & (h.slot_count - 1));
+      return slot->sequence.load(std::memory_order_acquire) != pos + 1;
+    }
+
+  private:
+    struct header
+    {
+        static constexpr const uint32_t magic_value = 0x4F534352; // "OSCR"
+
+        std::atomic<uint32_t> magic{0};
+        std::atomic<uint32_t> closed{0};
+        uint32_t slot_count{};
+        uint32_t slot_size{};
+        int32_t owner{};
+
+        alignas(64) std::atomic<uint64_t> enqueue_pos{0};
+        alignas(64) std::atomic<uint64_t> dequeue_pos{0};
+        alignas(64) std::atomic<uint32_t> futex{0};
+        std::atomic<uint32_t> sleeping{0};
+    };
+
+    struct slot_header
+    {
+        slot_header(uint64_t seq): sequence{seq} { }
+        std::atomic<uint64_t> sequence;
+        uint32_t size{};
+        uint32_t padding{};
+    };
+
+    static_assert(ATOMIC_LLONG_LOCK_FREE == 2 && ATOMIC_INT_LOCK_FREE == 2,
+                  "Shared memory requires address-free atomics");
+
+    static std::size_t slot_stride(uint32_t slot_size)
+    {
+      return (sizeof(slot_header) + slot_size + 63) / 64 * 64;
+    }
+
+    slot_header* slot_at(uint64_t i) const
+    {
+      auto base = reinterpret_cast<char*>(m_header) + sizeof(header);
+      return reinterpret_cast<slot_header*>(base + i * slot_stride(m_header->slot_size));
+    }
+
+    bool map(int fd, std::size_t size)
+    {
+      auto p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+      if(p == MAP_FAILED)
+        return false;
+
+      m_header = static_cast<header*>(p);
+      m_mapSize = size;
+      return true;
+    }
+
+    bool identify(int fd)
+    {
+      struct stat st;
+      if(::fstat(fd, &st) < 0)
+        return false;
+      m_inode = st.st_ino;
+      m_device = st.st_dev;
+      return true;
+    }
+
+    void unmap()
+    {
+      ::munmap(m_header, m_mapSize);
+      m_header = nullptr;
+      m_mapSize = 0;
+    }
+
+    // Removes a segment whose owner is not running anymore.
+    static bool reclaim(const std::string& name)
+    {
+      // If it cannot be opened, it may be still being created.
+      shm_ring other;
+      if(!other.open(name))
+        return false;
+
+      auto pid = other.m_header->owner;
+      if(!other.m_header->closed.load() && ::kill(pid, 0) == 0)
+        return false;
+
+      ::shm_unlink(name.c_str());
+      return true;
+    }
+
+    static void wake(std::atomic<uint32_t>& word)
+    {
+#if defined(__linux__)
+      ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, 1, nullptr, nullptr, 0);
+#else
+      (void) word;
+#endif
+    }
+
+    static void sleep(std::atomic<uint32_t>& word, uint32_t value, std::chrono::milliseconds timeout)
+    {
+#if defined(__linux__)
+      timespec ts{
+        time_t(timeout.count() / 1000),
+        long((timeout.count() % 1000) * 1000000)};
+      ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT, value, &ts, nullptr, 0);
+#else
+      // No portable cross-process wait : poll.
+      (void) word; (void) value; (void) timeout;
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+#endif
+    }
+
+    std::string m_name;
+    header* m_header{};
+    std::size_t m_mapSize{};
+    ino_t m_inode{};
+    dev_t m_device{};
+    bool m_owner = false;
+};
+
+}
+}
@@ -0,0 +1,136 @@
+#pragma once
+#include <coppa/protocol/osc/oscmessagegenerator.hpp>
+#include <coppa/protocol/osc/oscshmring.hpp>
+#include <coppa/string_view.hpp>
+
+#include <chrono>
+#include <string>
+
+namespace coppa
+{
+namespace osc
+{
+/**
+ * @brief The shm_sender class
+ *
+ * Sends OSC packets to a shm_receiver of the same host,
+ * through the shared memory segment of the given port.
+ * It has the same interface as coppa::osc::sender; the ip is ignored.
+ *
+ * If the receiver is not running, or is restarted,
+ * the segment is opened again when sending.
+ * A receiver that stopped without closing the segment, e.g. that crashed,
+ * is noticed when the queue is full and every few hundred packets,
+ * at most every 100 ms.
+ * As with UDP, packets are dropped if the receiver cannot keep up.
+ */
+class shm_sender
+{
+  public:
+    using clock = std::chrono::steady_clock;
+
+    shm_sender() = default;
+    shm_sender(shm_sender&&) = default;
+    shm_sender(const shm_sender&) = delete;
+    shm_sender& operator=(shm_sender&&) = default;
+    shm_sender& operator=(const shm_sender&) = delete;
+
+    shm_sender(const std::string& ip, const int port):
+      m_ip(ip),
+      m_port(port)
+    {
+      reopen();
+    }
+
+    template<typename... Args>
+    void send(const std::string& address, Args&&... args)
+    {
+      send_impl(oscpack::MessageGenerator<>{}(
+                  address,
+                  std::forward<Args>(args)...));
+    }
+
+    template<typename... Args>
+    void send(string_view address, Args&&... args)
+    {
+      send_impl(oscpack::MessageGenerator<>{}(
+                  address,
+                  std::forward<Args>(args)...));
+    }
+
+    template<int N, typename... Args>
+    void send(oscpack::small_string_base<N> address, Args&&... args)
+    {
+      send_impl(oscpack::MessageGenerator<>{}(
+                  address,
+                  std::forward<Args>(args)...));
+    }
+
+    // Sends an already serialized packet (message or bundle).
+    // Returns false if it was dropped.
+    bool send_raw(const char* data, std::size_t size)
+    {
+      if(!m_ring.valid() && !reopen())
+        return false;
+
+      if(m_ring.push(data, size))
+      {
+        if(++m_pushed % check_period == 0)
+          check_receiver();
+        return true;
+      }
+
+      // Full : the receiver may be gone.
+      if(!check_receiver())
+        return false;
+      return reopen() && m_ring.push(data, size);
+    }
+
+    const std::string& ip() const { return m_ip; }
+    int port() const { return m_port; }
+
+  private:
+    static const constexpr uint32_t check_period = 256;
+
+    // Closes the segment if nobody reads it anymore ;
+    // returns true in this case.
+    bool check_receiver()
+    {
+      const auto now = clock::now();
+      if(now < m_nextCheck)
+        return false;
+      m_nextCheck = now + std::chrono::milliseconds(100);
+
+      if(!m_ring.stale())
+        return false;
+      m_ring.close();
+      m_nextOpen = {};
+      return true;
+    }
+
+    void send_impl(const oscpack::OutboundPacketStream& m)
+    {
+      send_raw(m.Data(), m.Size());
+    }
+
+    bool reopen()
+    {
+      // Not more than once in a while, to not make a system call per message.
+      const auto now = clock::now();
+      if(now < m_nextOpen)
+        return false;
+      m_nextOpen = now + std::chrono::milliseconds(100);
+
+      return m_ring.open(shm_ring::segment_name(m_port));
+    }
+
+    shm_ring m_ring;
+    clock::time_point m_nextOpen{};
+    clock::time_point m_nextCheck{};
+    uint32_t m_pushed{};
+    std::string m_ip;
+    int m_port{};
+};
+
+}
+}
@@ -0,0 +1,266 @@
+#pragma once
+#include <algorithm>
+#include <string>
+#include <cstring>
+#include <cstdint>
+
+namespace coppa
+{
+namespace osc
+{
+/**
+ * @brief The framings of OSC packets on a stream (e.g. TCP)
+ */
+enum class stream_framing
+{
+  Slip,        // OSC 1.1 : double-END SLIP encoding (RFC 1055)
+  LengthPrefix // OSC 1.0 : each packet is preceded by its size as a big-endian int32
+};
+
+namespace slip
+{
+static constexpr const char end = char(0xC0);
+static constexpr const char esc = char(0xDB);
+static constexpr const char esc_end = char(0xDC);
+static constexpr const char esc_esc = char(0xDD);
+}
+
+// Appends a framed packet at the end of out.
+inline void write_frame(
+    std::string& out,
+    const char* data,
+    std::size_t size,
+    stream_framing framing)
+{
+  switch(framing)
+  {
+    case stream_framing::Slip:
+    {
+      out.reserve(out.size() + size + 2);
+      out.push_back(slip::end);
+
+      // Copies the runs of bytes that do not need escaping at once.
+      const char* run = data;
+      const char* const data_end = data + size;
+      for(const char* it = data; it != data_end; ++it)
+      {
+        if(*it == slip::end || *it == slip::esc)
+        {
+          out.append(run, it - run);
+          out.push_back(slip::esc);
+          out.push_back(*it == slip::end ? slip::esc_end : slip::esc_esc);
+          run = it + 1;
+        }
+      }
+      out.append(run, data_end - run);
+
+      out.push_back(slip::end);
+      break;
+    }
+
+    case stream_framing::LengthPrefix:
+    {
+      const auto n = static_cast<uint32_t>(size);
+      const char prefix[4] = {
+        char((n >> 24) & 0xFF),
+        char((n >> 16) & 0xFF),
+        char((n >> 8) & 0xFF),
+        char(n & 0xFF)
+      };
+      out.append(prefix, 4);
+      out.append(data, size);
+      break;
+    }
+  }
+}
+
+// In a buffer of frames written by write_frame, of which only the first
+// "written" bytes were sent, returns the offset of the first frame
+// that was not entirely sent.
+inline std::size_t first_unsent_frame(
+    const std::string& frames,
+    std::size_t written,
+    stream_framing framing)
+{
+  std::size_t offset = 0;
+  while(offset < frames.size())
+  {
+    std::size_t next = frames.size();
+    switch(framing)
+    {
+      case stream_framing::Slip:
+      {
+        // Escaped data does not contain END bytes.
+        const auto last = frames.find(slip::end, offset + 1);
+        if(last != std::string::npos)
+          next = last + 1;
+        break;
+      }
+
+      case stream_framing::LengthPrefix:
+      {
+        if(frames.size() - offset < 4)
+          break;
+        const auto b = reinterpret_cast<const unsigned char*>(frames.data() + offset);
+        const std::size_t n = (uint32_t(b[0]) << 24) | (uint32_t(b[1]) << 16)
+                            | (uint32_t(b[2]) << 8) | uint32_t(b[3]);
+        next = std::min(frames.size(), offset + 4 + n);
+        break;
+      }
+    }
+
+    if(next > written)
+      return offset;
+    offset = next;
+  }
+  return frames.size();
+}
+
+/**
+ * @brief The stream_decoder class
+ *
+ * Splits a byte stream into OSC packets.
+ * Bytes can be fed in chunks of any size; a packet split across
+ * chunks is kept until it is complete.
+ *
+ * For length-prefixed streams, the packets that are entirely in a chunk
+ * are passed without copy.
+ */
+class stream_decoder
+{
+  public:
+    stream_decoder(
+        stream_framing framing,
+        std::size_t max_packet_size = 16 * 1024 * 1024):
+      m_framing{framing},
+      m_maxPacketSize{max_packet_size}
+    {
+    }
+
+    // on_packet is called with (const char* data, std::size_t size)
+    // for every complete packet.
+    // Returns false if the stream is invalid, e.g. a packet is too big.
+    template<typename PacketHandler>
+    bool feed(const char* data, std::size_t size, PacketHandler&& on_packet)
+    {
+      switch(m_framing)
+      {
+        case stream_framing::Slip:
+          return feed_slip(data, size, on_packet);
+        case stream_framing::LengthPrefix:
+          return feed_length_prefix(data, size, on_packet);
+      }
+      return false;
+    }
+
+  private:
+    template<typename PacketHandler>
+    bool feed_slip(const char* data, std::size_t size, PacketHandler& on_packet)
+    {
+      const char* run = data;
+      const char* const data_end = data + size;
+      for(const char* it = data; it != data_end; ++it)
+      {
+        if(m_escape)
+        {
+          m_escape = false;
+          if(*it == slip::esc_end)
+            m_buffer.push_back(slip::end);
+          else if(*it == slip::esc_esc)
+            m_buffer.push_back(slip::esc);
+          else
+            return false;
+          run = it + 1;
+        }
+        else if(*it == slip::esc)
+        {
+          m_buffer.append(run, it - run);
+          run = it + 1;
+          m_escape = true;
+        }
+        else if(*it == slip::end)
+        {
+          m_buffer.append(run, it - run);
+          run = it + 1;
+
+          // Empty packets are the result of the double END framing.
+          if(!m_buffer.empty())
+          {
+            on_packet(m_buffer.data(), m_buffer.size());
+            m_buffer.clear();
+          }
+        }
+      }
+
+      m_buffer.append(run, data_end - run);
+
+      return m_buffer.size() <= m_maxPacketSize;
+    }
+
+    template<typename PacketHandler>
+    bool feed_length_prefix(const char* data, std::size_t size, PacketHandler& on_packet)
+    {
+      if(!m_buffer.empty())
+      {
+        // Completes the pending packet first.
+        const auto missing = [&] {
+          if(m_buffer.size() < 4)
+            return 4 - m_buffer.size();
+          return 4 + packet_size(m_buffer.data()) - m_buffer.size();
+        };
+
+        while(size > 0 && missing() > 0)
+        {
+          auto n = std::min(missing(), size);
+          m_buffer.append(data, n);
+          data += n;
+          size -= n;
+
+          if(m_buffer.size() == 4 && packet_size(m_buffer.data()) > m_maxPacketSize)
+            return false;
+        }
+
+        if(missing() > 0)
+          return true;
+
+        if(m_buffer.size() > 4)
+          on_packet(m_buffer.data() + 4, m_buffer.size() - 4);
+        m_buffer.clear();
+      }
+
+      // The complete packets are read in place.
+      while(size >= 4)
+      {
+        const auto n = packet_size(data);
+        if(n > m_maxPacketSize)
+          return false;
+        if(size < 4 + n)
+          break;
+
+        if(n > 0)
+          on_packet(data + 4, n);
+        data += 4 + n;
+        size -= 4 + n;
+      }
+
+      m_buffer.assign(data, size);
+      return true;
+    }
+
+    static std::size_t packet_size(const char* p)
+    {
+      auto u = reinterpret_cast<const unsigned char*>(p);
+      return (std::size_t(u[0]) << 24)
+          | (std::size_t(u[1]) << 16)
+          | (std::size_t(u[2]) << 8)
+          | std::size_t(u[3]);
+    }
+
+    std::string m_buffer;
+    stream_framing m_framing{};
+    std::size_t m_maxPacketSize{};
+    bool m_escape = false;
+};
+
+}
+}
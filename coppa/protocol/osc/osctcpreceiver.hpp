@@ -0,0 +1,205 @@
+#pragma once
+#include <coppa/protocol/osc/oscreceiver.hpp>
+#include <coppa/protocol/osc/oscstream.hpp>
+
+#include <boost/asio.hpp>
+#include <array>
+#include <memory>
+#include <set>
+#include <thread>
+
+namespace coppa
+{
+namespace osc
+{
+/**
+ * @brief The tcp_receiver class
+ *
+ * A OSC server over TCP, with the same interface as coppa::osc::receiver.
+ * Many clients can be connected at the same time; the packets of every
+ * connection are passed to the same handler.
+ *
+ * Note : if a port cannot be opened, it will be incremented.
+ */
+class tcp_receiver
+{
+  public:
+    tcp_receiver() = default;
+    tcp_receiver(tcp_receiver&&) = default;
+    tcp_receiver& operator=(tcp_receiver&&) = default;
+
+    template<typename Handler>
+    tcp_receiver(
+        unsigned int port,
+        Handler msg,
+        stream_framing framing = stream_framing::Slip):
+      m_impl{std::make_unique<impl>(
+               std::make_unique<listener<Handler>>(msg),
+               framing)}
+    {
+      setPort(port);
+    }
+
+    ~tcp_receiver()
+    {
+      stop();
+    }
+
+    void run()
+    {
+      stop();
+      m_impl->service.reset();
+      auto& service = m_impl->service;
+      m_impl->thread = std::thread([&service] { service.run(); });
+    }
+
+    void stop()
+    {
+      if(!m_impl)
+        return;
+
+      m_impl->service.stop();
+      if(m_impl->thread.joinable())
+        m_impl->thread.join();
+    }
+
+    unsigned int port() const
+    {
+      return m_impl->port;
+    }
+
+    unsigned int setPort(unsigned int port)
+    {
+      return m_impl->listen(port);
+    }
+
+  private:
+    class session;
+    struct impl
+    {
+        impl(std::unique_ptr<oscpack::OscPacketListener> l, stream_framing f):
+          packet_listener{std::move(l)},
+          framing{f},
+          acceptor{service}
+        {
+        }
+
+        ~impl()
+        {
+          service.stop();
+          if(thread.joinable())
+            thread.join();
+        }
+
+        unsigned int listen(unsigned int p)
+        {
+          using namespace boost::asio::ip;
+          port = p;
+
+          boost::system::error_code ec;
+          acceptor.close(ec);
+
+          while(true)
+          {
+            acceptor.open(tcp::v4(), ec);
+            acceptor.set_option(tcp::acceptor::reuse_address(true), ec);
+            acceptor.bind(tcp::endpoint{tcp::v4(), static_cast<unsigned short>(port)}, ec);
+            if(!ec)
+              acceptor.listen(boost::asio::socket_base::max_connections, ec);
+            if(!ec)
+              break;
+
+            acceptor.close(ec);
+            port++;
+          }
+
+          accept();
+          return port;
+        }
+
+        void accept()
+        {
+          auto s = std::make_shared<session>(*this);
+          acceptor.async_accept(s->socket, [this,s] (const boost::system::error_code& ec) {
+            if(ec)
+              return;
+
+            sessions.insert(s);
+            s->start();
+            accept();
+          });
+        }
+
+        std::unique_ptr<oscpack::OscPacketListener> packet_listener;
+        stream_framing framing{};
+        unsigned int port = 0;
+
+        boost::asio::io_service service;
+        boost::asio::ip::tcp::acceptor acceptor;
+        std::set<std::shared_ptr<session>> sessions;
+        std::thread thread;
+    };
+
+    // A connected client.
+    class session : public std::enable_shared_from_this<session>
+    {
+      public:
+        session(impl& parent):
+          socket{parent.service},
+          m_parent{parent},
+          m_decoder{parent.framing}
+        {
+        }
+
+        void start()
+        {
+          boost::system::error_code ec;
+          auto ep = socket.remote_endpoint(ec);
+          if(!ec && ep.address().is_v4())
+            m_remote = oscpack::IpEndpointName(ep.address().to_v4().to_ulong(), ep.port());
+
+          read();
+        }
+
+        boost::asio::ip::tcp::socket socket;
+
+      private:
+        void read()
+        {
+          auto self = shared_from_this();
+          socket.async_read_some(
+                boost::asio::buffer(m_buffer),
+                [this,self] (const boost::system::error_code& ec, std::size_t n) {
+            if(ec || !m_decoder.feed(m_buffer.data(), n, [&] (const char* data, std::size_t size) {
+              try
+              {
+                m_parent.packet_listener->ProcessPacket(data, static_cast<int>(size), m_remote);
+              }
+              catch(std::exception& e)
+              {
+                std::cerr << "OSC Parse Error: " << e.what() << std::endl;
+              }
+            }))
+            {
+              // Disconnected, or the stream is corrupted.
+              boost::system::error_code err;
+              socket.close(err);
+              m_parent.sessions.erase(self);
+              return;
+            }
+
+            read();
+          });
+        }
+
+        impl& m_parent;
+        stream_decoder m_decoder;
+        oscpack::IpEndpointName m_remote;
+        std::array<char, 65536> m_buffer;
+    };
+
+    std::unique_ptr<impl> m_impl;
+};
+
+}
+}
@@ -0,0 +1,294 @@
+#pragma once
+#include <coppa/protocol/osc/oscmessagegenerator.hpp>
+#include <coppa/protocol/osc/oscstream.hpp>
+#include <coppa/string_view.hpp>
+
+#include <boost/asio.hpp>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace coppa
+{
+namespace osc
+{
+/**
+ * @brief The tcp_sender class
+ *
+ * Sends OSC packets to a given address on a TCP port.
+ * It has the same interface as coppa::osc::sender.
+ *
+ * Messages are framed and appended to a buffer; a single write
+ * is in flight at any time, and every message sent in the meantime
+ * goes with the next one. Under load, many messages are written per system call.
+ *
+ * The connection is made asynchronously, and made again
+ * if it is lost. Messages sent while the sender is not connected are
+ * kept, up to max_pending_size bytes; so are the messages that a failed
+ * write did not entirely send, which are written again first.
+ *
+ * On destruction, what is pending is written for at most a second;
+ * past this, it is dropped.
+ */
+class tcp_sender
+{
+  public:
+    tcp_sender() = default;
+    tcp_sender(tcp_sender&&) = default;
+    tcp_sender(const tcp_sender&) = delete;
+    tcp_sender& operator=(tcp_sender&&) = default;
+    tcp_sender& operator=(const tcp_sender&) = delete;
+
+    tcp_sender(
+        const std::string& ip,
+        const int port,
+        stream_framing framing = stream_framing::Slip):
+      m_impl{std::make_unique<impl>(ip, port, framing)}
+    {
+    }
+
+    template<typename... Args>
+    void send(const std::string& address, Args&&... args)
+    {
+      send_message(address, std::forward<Args>(args)...);
+    }
+
+    template<typename... Args>
+    void send(string_view address, Args&&... args)
+    {
+      send_message(address, std::forward<Args>(args)...);
+    }
+
+    template<int N, typename... Args>
+    void send(oscpack::small_string_base<N> address, Args&&... args)
+    {
+      send_message(address, std::forward<Args>(args)...);
+    }
+
+    // Sends an already serialized packet (message or bundle).
+    void send_raw(const char* data, std::size_t size)
+    {
+      m_impl->write(data, size);
+    }
+
+    bool connected() const { return m_impl->connected(); }
+
+    const std::string& ip() const { return m_impl->ip; }
+    int port() const { return m_impl->port; }
+
+  private:
+    template<typename Name, typename... Args>
+    void send_message(const Name& address, Args&&... args)
+    {
+      try
+      {
+        send_impl(oscpack::MessageGenerator<>{}(address, args...));
+      }
+      catch(const oscpack::OutOfBufferMemoryException&)
+      {
+        // Unlike UDP, big messages can be sent over TCP.
+        send_impl(oscpack::DynamicMessageGenerator{}(address, args...));
+      }
+    }
+
+    void send_impl(const oscpack::OutboundPacketStream& m)
+    {
+      m_impl->write(m.Data(), m.Size());
+    }
+
+    struct impl
+    {
+        impl(const std::string& ip_, int port_, stream_framing framing):
+          ip{ip_},
+          port{port_},
+          m_framing{framing},
+          m_work{std::make_unique<boost::asio::io_service::work>(m_service)},
+          m_socket{m_service},
+          m_timer{m_service},
+          m_endpoint{boost::asio::ip::address::from_string(ip_), static_cast<unsigned short>(port_)}
+        {
+          connect();
+          m_thread = std::thread([this] { m_service.run(); });
+        }
+
+        ~impl()
+        {
+          // What is pending is written before closing, unless the peer
+          // does not read it in time.
+          m_service.post([this] {
+            m_closing = true;
+
+            // Also cancels a wait before reconnecting.
+            m_timer.expires_from_now(boost::posix_time::seconds(1));
+            m_timer.async_wait([this] (const boost::system::error_code& ec) {
+              if(ec)
+                return;
+              close();
+              m_service.stop();
+            });
+
+            std::unique_lock<std::mutex> l{m_mutex};
+            if(!m_writing)
+            {
+              l.unlock();
+              close();
+            }
+          });
+          m_work.reset();
+          m_thread.join();
+        }
+
+        void write(const char* data, std::size_t size)
+        {
+          std::lock_guard<std::mutex> l{m_mutex};
+          if(m_pending.size() + size > max_pending_size)
+            return; // Like UDP, the message is dropped if there is no room.
+
+          write_frame(m_pending, data, size, m_framing);
+          if(m_connected && !m_writing)
+          {
+            m_writing = true;
+            m_service.post([this] { do_write(); });
+          }
+        }
+
+        bool connected() const
+        {
+          std::lock_guard<std::mutex> l{m_mutex};
+          return m_connected;
+        }
+
+        const std::string ip;
+        const int port{};
+
+        static const constexpr std::size_t max_pending_size = 64 * 1024 * 1024;
+
+      private:
+        void connect()
+        {
+          m_socket.async_connect(m_endpoint, [this] (const boost::system::error_code& ec) {
+            if(m_closing)
+              return;
+
+            if(ec)
+            {
+              reconnect();
+              return;
+            }
+
+            m_socket.set_option(boost::asio::ip::tcp::no_delay(true));
+
+            std::lock_guard<std::mutex> l{m_mutex};
+            m_connected = true;
+            if(!m_pending.empty())
+            {
+              m_writing = true;
+              m_service.post([this] { do_write(); });
+            }
+          });
+        }
+
+        void reconnect()
+        {
+          {
+            std::lock_guard<std::mutex> l{m_mutex};
+            m_connected = false;
+            m_writing = false;
+          }
+          boost::system::error_code ec;
+          m_socket.close(ec);
+
+          m_timer.expires_from_now(boost::posix_time::milliseconds(500));
+          m_timer.async_wait([this] (const boost::system::error_code& ec) {
+            if(!ec && !m_closing)
+              connect();
+          });
+        }
+
+        void close()
+        {
+          boost::system::error_code ec;
+          m_timer.cancel(ec);
+          m_socket.shutdown(boost::asio::ip::tcp::socket::shutdown_both, ec);
+          m_socket.close(ec);
+        }
+
+        // Called from the io_service thread only.
+        void do_write()
+        {
+          {
+            std::lock_guard<std::mutex> l{m_mutex};
+            std::swap(m_pending, m_inFlight);
+            m_pending.clear();
+          }
+
+          boost::asio::async_write(
+                m_socket,
+                boost::asio::buffer(m_inFlight),
+                [this] (const boost::system::error_code& ec, std::size_t written) {
+            if(ec)
+            {
+              if(m_closing)
+              {
+                close();
+              }
+              else
+              {
+                requeue(written);
+                reconnect();
+              }
+              return;
+            }
+
+            std::unique_lock<std::mutex> l{m_mutex};
+            if(!m_pending.empty())
+            {
+              l.unlock();
+              do_write();
+            }
+            else
+            {
+              m_writing = false;
+              l.unlock();
+              if(m_closing)
+                close();
+            }
+          });
+        }
+
+        // Puts back what a failed write did not entirely send
+        // before the messages sent in the meantime.
+        void requeue(std::size_t written)
+        {
+          m_inFlight.erase(0, first_unsent_frame(m_inFlight, written, m_framing));
+
+          std::lock_guard<std::mutex> l{m_mutex};
+          m_inFlight += m_pending;
+          std::swap(m_pending, m_inFlight);
+          m_inFlight.clear();
+        }
+
+        stream_framing m_framing{};
+
+        boost::asio::io_service m_service;
+        std::unique_ptr<boost::asio::io_service::work> m_work;
+        boost::asio::ip::tcp::socket m_socket;
+        boost::asio::deadline_timer m_timer;
+        boost::asio::ip::tcp::endpoint m_endpoint;
+        std::thread m_thread;
+
+        mutable std::mutex m_mutex;
+        std::string m_pending;
+        std::string m_inFlight;
+        bool m_connected = false;
+        bool m_writing = false;
+        bool m_closing = false;
+    };
+
+    std::unique_ptr<impl> m_impl;
+};
+
+}
+}
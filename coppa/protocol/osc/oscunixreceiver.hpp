@@ -0,0 +1,195 @@
+#pragma once
+#include <coppa/protocol/osc/oscreceiver.hpp>
+#include <coppa/protocol/osc/oscunixsocket.hpp>
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include <cerrno>
+#include <unistd.h>
+
+namespace coppa
+{
+namespace osc
+{
+/**
+ * @brief The unix_receiver class
+ *
+ * A OSC server for the processes of the same host,
+ * with the same interface as coppa::osc::receiver.
+ * It listens on an AF_UNIX datagram socket whose path depends on the port
+ * (see unix_socket_path).
+ *
+ * A socket file left by a process that does not run anymore is reused;
+ * if the socket is in use, the port is incremented.
+ */
+class unix_receiver
+{
+  public:
+    unix_receiver() = default;
+    unix_receiver(unix_receiver&&) = default;
+    unix_receiver& operator=(unix_receiver&&) = default;
+
+    template<typename Handler>
+    unix_receiver(unsigned int port, Handler msg):
+      m_impl{std::make_unique<impl>(std::make_unique<listener<Handler>>(msg))}
+    {
+      setPort(port);
+    }
+
+    ~unix_receiver()
+    {
+      stop();
+    }
+
+    void run()
+    {
+      stop();
+      m_impl->running = true;
+      m_impl->thread = std::thread([impl = m_impl.get()] { impl->run(); });
+    }
+
+    void stop()
+    {
+      if(m_impl)
+        m_impl->stop();
+    }
+
+    unsigned int port() const
+    {
+      return m_impl->port;
+    }
+
+    unsigned int setPort(unsigned int port)
+    {
+      const bool was_running = m_impl->running;
+      stop();
+
+      m_impl->close();
+      m_impl->port = port;
+      while(!m_impl->bind())
+        m_impl->port++;
+
+      if(was_running)
+        run();
+      return m_impl->port;
+    }
+
+  private:
+    struct impl
+    {
+        impl(std::unique_ptr<oscpack::OscPacketListener> l):
+          packet_listener{std::move(l)}
+        {
+        }
+
+        ~impl()
+        {
+          stop();
+          close();
+        }
+
+        bool bind()
+        {
+          sockaddr_un addr;
+          path = unix_socket_path(port);
+          if(!make_unix_address(path, addr))
+            return false;
+
+          socket = ::socket(AF_UNIX, SOCK_DGRAM, 0);
+          if(socket < 0)
+            return false;
+
+          if(::bind(socket, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0)
+            return true;
+
+          if(errno == EADDRINUSE && stale(addr))
+          {
+            ::unlink(path.c_str());
+            if(::bind(socket, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0)
+              return true;
+          }
+
+          ::close(socket);
+          socket = -1;
+          return false;
+        }
+
+        void close()
+        {
+          if(socket < 0)
+            return;
+
+          ::close(socket);
+          ::unlink(path.c_str());
+          socket = -1;
+        }
+
+        void stop()
+        {
+          if(!running)
+            return;
+          running = false;
+
+          // Wakes up the thread blocked in recv with an empty datagram.
+          sockaddr_un addr;
+          int s = ::socket(AF_UNIX, SOCK_DGRAM, 0);
+          if(s >= 0 && make_unix_address(path, addr))
+            ::sendto(s, nullptr, 0, 0, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+          if(s >= 0)
+            ::close(s);
+
+          if(thread.joinable())
+            thread.join();
+        }
+
+        void run()
+        {
+          const oscpack::IpEndpointName localhost{0x7F000001UL, 0};
+          while(running)
+          {
+            auto n = ::recv(socket, buffer.data(), buffer.size(), 0);
+            if(n <= 0)
+              continue;
+
+            try
+            {
+              packet_listener->ProcessPacket(buffer.data(), static_cast<int>(n), localhost);
+            }
+            catch(std::exception& e)
+            {
+              std::cerr << "OSC Parse Error: " << e.what() << std::endl;
+            }
+          }
+        }
+
+        // Nobody listens on the socket file anymore.
+        static bool stale(const sockaddr_un& addr)
+        {
+          int s = ::socket(AF_UNIX, SOCK_DGRAM, 0);
+          if(s < 0)
+            return false;
+
+          bool res = ::connect(s, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) < 0
+                     && errno == ECONNREFUSED;
+          ::close(s);
+          return res;
+        }
+
+        std::unique_ptr<oscpack::OscPacketListener> packet_listener;
+        std::string path;
+        unsigned int port = 0;
+        int socket = -1;
+
+        std::atomic_bool running{false};
+        std::thread thread;
+        std::array<char, 65536> buffer;
+    };
+
+    std::unique_ptr<impl> m_impl;
+};
+
+}
+}
@@ -0,0 +1,139 @@
+#pragma once
+#include <coppa/protocol/osc/oscmessagegenerator.hpp>
+#include <coppa/protocol/osc/oscunixsocket.hpp>
+#include <coppa/string_view.hpp>
+
+#include <chrono>
+#include <string>
+#include <utility>
+
+#include <cerrno>
+#include <unistd.h>
+
+namespace coppa
+{
+namespace osc
+{
+/**
+ * @brief The unix_sender class
+ *
+ * Sends OSC packets to a unix_receiver of the same host,
+ * over the AF_UNIX datagram socket of the given port.
+ * It has the same interface as coppa::osc::sender; the ip is ignored.
+ *
+ * Unlike UDP, datagrams are not lost : if the receiver cannot
+ * keep up, send blocks until there is room.
+ * The socket is connected again if the receiver is restarted.
+ */
+class unix_sender
+{
+  public:
+    using clock = std::chrono::steady_clock;
+
+    unix_sender() = default;
+    unix_sender(const unix_sender&) = delete;
+    unix_sender& operator=(const unix_sender&) = delete;
+
+    unix_sender(unix_sender&& other) noexcept
+    {
+      *this = std::move(other);
+    }
+
+    unix_sender& operator=(unix_sender&& other) noexcept
+    {
+      std::swap(m_socket, other.m_socket);
+      std::swap(m_nextConnect, other.m_nextConnect);
+      std::swap(m_ip, other.m_ip);
+      std::swap(m_port, other.m_port);
+      return *this;
+    }
+
+    unix_sender(const std::string& ip, const int port):
+      m_ip(ip),
+      m_port(port)
+    {
+      reconnect();
+    }
+
+    ~unix_sender()
+    {
+      if(m_socket >= 0)
+        ::close(m_socket);
+    }
+
+    template<typename... Args>
+    void send(const std::string& address, Args&&... args)
+    {
+      send_impl(oscpack::MessageGenerator<>{}(
+                  address,
+                  std::forward<Args>(args)...));
+    }
+
+    template<typename... Args>
+    void send(string_view address, Args&&... args)
+    {
+      send_impl(oscpack::MessageGenerator<>{}(
+                  address,
+                  std::forward<Args>(args)...));
+    }
+
+    template<int N, typename... Args>
+    void send(oscpack::small_string_base<N> address, Args&&... args)
+    {
+      send_impl(oscpack::MessageGenerator<>{}(
+                  address,
+                  std::forward<Args>(args)...));
+    }
+
+    // Sends an already serialized packet (message or bundle).
+    void send_raw(const char* data, std::size_t size)
+    {
+      if(m_socket < 0 && !reconnect())
+        return;
+
+      if(::send(m_socket, data, size, 0) < 0
+      && (errno == ECONNREFUSED || errno == ENOTCONN)
+      && reconnect())
+      {
+        // The receiver was restarted
+        ::send(m_socket, data, size, 0);
+      }
+    }
+
+    const std::string& ip() const { return m_ip; }
+    int port() const { return m_port; }
+
+  private:
+    void send_impl(const oscpack::OutboundPacketStream& m)
+    {
+      send_raw(m.Data(), m.Size());
+    }
+
+    bool reconnect()
+    {
+      // Not more than once in a while, to not make a system call per message.
+      const auto now = clock::now();
+      if(now < m_nextConnect)
+        return false;
+      m_nextConnect = now + std::chrono::milliseconds(100);
+
+      if(m_socket < 0)
+        m_socket = ::socket(AF_UNIX, SOCK_DGRAM, 0);
+      if(m_socket < 0)
+        return false;
+
+      sockaddr_un addr;
+      if(!make_unix_address(unix_socket_path(m_port), addr))
+        return false;
+
+      return ::connect(m_socket, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+    }
+
+    int m_socket = -1;
+    clock::time_point m_nextConnect{};
+    std::string m_ip;
+    int m_port{};
+};
+
+}
+}
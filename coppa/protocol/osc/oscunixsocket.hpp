@@ -0,0 +1,33 @@
+#pragma once
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+
+namespace coppa
+{
+namespace osc
+{
+// Path of the Unix socket used for a given port.
+inline std::string unix_socket_path(unsigned int port)
+{
+  const char* dir = std::getenv("TMPDIR");
+  return std::string(dir && *dir ? dir : "/tmp") + "/coppa.osc." + std::to_string(port);
+}
+
+// Returns false if the path does not fit in a sockaddr_un.
+inline bool make_unix_address(const std::string& path, sockaddr_un& addr)
+{
+  addr = sockaddr_un{};
+  addr.sun_family = AF_UNIX;
+  if(path.size() >= sizeof(addr.sun_path))
+    return false;
+
+  std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+  return true;
+}
+
+}
+}
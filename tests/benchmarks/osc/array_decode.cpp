@@ -0,0 +1,81 @@
+#include <coppa/ossia/device/osc_common.hpp>
+#include <coppa/minuit/device/osc_common.hpp>
+#include <oscpack/osc/OscOutboundPacketStream.h>
+#include <oscpack/osc/OscReceivedElements.h>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+// Decodes a message of 4096 floats, one by one, in bulk,
+// and into a float_array.
+static const constexpr int float_count = 4096;
+static const constexpr int iterations = 2000;
+
+template<typename Fun>
+void bench(const char* name, Fun decode)
+{
+  using clock = std::chrono::steady_clock;
+  decode();
+
+  auto start = clock::now();
+  for(int i = 0; i < iterations; i++)
+    decode();
+  auto end = clock::now();
+
+  auto us = std::chrono::duration<double, std::micro>(end - start).count();
+  std::cout << name << ": " << us / iterations << " us / message" << std::endl;
+}
+
+int main()
+{
+  using namespace coppa;
+
+  std::vector<char> buffer(float_count * 4 + 8192);
+  {
+    oscpack::OutboundPacketStream s{buffer.data(), buffer.size()};
+    s << oscpack::BeginMessage("/spectrum");
+    for(int i = 0; i < float_count; i++)
+      s << float(i);
+    s << oscpack::EndMessage();
+    buffer.resize(s.Size());
+  }
+  oscpack::ReceivedMessage flat{oscpack::ReceivedPacket{buffer.data(), static_cast<int>(buffer.size())}};
+
+  ossia::Tuple tuple;
+  bench("ossia, one by one", [&] {
+    ossia::convert_tuple(flat.ArgumentsBegin(), flat.ArgumentsEnd(), tuple);
+  });
+  bench("ossia, bulk", [&] {
+    ossia::convert_tuple(flat, tuple);
+  });
+
+  ossia::Value floats{ossia::float_array{}};
+  bench("ossia float_array", [&] {
+    ossia::read_value_in_place(flat, floats);
+  });
+  std::cout << "memory, Tuple: " << float_count * sizeof(ossia::Variant)
+            << " bytes, float_array: " << float_count * sizeof(float)
+            << " bytes" << std::endl;
+
+  std::vector<char> array_buffer(float_count * 4 + 8192);
+  {
+    oscpack::OutboundPacketStream s{array_buffer.data(), array_buffer.size()};
+    s << oscpack::BeginMessage("/spectrum") << oscpack::ArrayInitiator{};
+    for(int i = 0; i < float_count; i++)
+      s << float(i);
+    s << oscpack::ArrayTerminator{} << oscpack::EndMessage();
+    array_buffer.resize(s.Size());
+  }
+  oscpack::ReceivedMessage array{oscpack::ReceivedPacket{array_buffer.data(), static_cast<int>(array_buffer.size())}};
+
+  minuit::Tuple t;
+  t.variants.resize(float_count, 0.f);
+  minuit::Values values{t};
+  using reader = minuit::values_reader<minuit::lax_error_handler, minuit::conversion_mode::Prechecked>;
+  bench("minuit array, one by one", [&] {
+    reader{}(array.ArgumentsBegin(), array.ArgumentsEnd(), values);
+  });
+  bench("minuit array, bulk", [&] {
+    reader{}(array.ArgumentsBegin(), array.ArgumentsEnd(), values, &array);
+  });
+}
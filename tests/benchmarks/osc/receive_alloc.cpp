@@ -0,0 +1,171 @@
+#include <coppa/ossia/device/osc_message_handler.hpp>
+#include <coppa/ossia/device/device_with_callbacks.hpp>
+#include <coppa/oscquery/device/message_handler.hpp>
+#include <coppa/oscquery/parameter.hpp>
+#include <coppa/map.hpp>
+#include <oscpack/osc/OscOutboundPacketStream.h>
+#include <oscpack/osc/OscReceivedElements.h>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+// Counts the allocations made while handling received messages.
+static std::atomic<long> allocation_count{0};
+
+void* operator new(std::size_t size)
+{
+  allocation_count++;
+  if(void* p = std::malloc(size))
+    return p;
+  throw std::bad_alloc{};
+}
+
+void operator delete(void* p) noexcept
+{
+  std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+  std::free(p);
+}
+
+static const constexpr int message_count = 1000000;
+
+template<typename Arg>
+static std::string make_message(const char* address, Arg arg)
+{
+  char buffer[1024];
+  oscpack::OutboundPacketStream p{buffer, sizeof(buffer)};
+  p << oscpack::BeginMessage(address) << arg << oscpack::EndMessage();
+  return std::string(p.Data(), p.Size());
+}
+
+template<typename Fun>
+void bench(const char* name, const std::string& packet, Fun handle)
+{
+  using clock = std::chrono::steady_clock;
+  oscpack::ReceivedMessage m{oscpack::ReceivedPacket{packet.data(), static_cast<int>(packet.size())}};
+
+  // The first message fills the address cache.
+  handle(m);
+
+  const auto allocations = allocation_count.load();
+  auto start = clock::now();
+  for(int i = 0; i < message_count; i++)
+    handle(m);
+  auto end = clock::now();
+
+  auto ns = std::chrono::duration<double, std::nano>(end - start).count();
+  std::cout << name << ": "
+            << double(allocation_count - allocations) / message_count << " allocations / message, "
+            << ns / message_count << " ns / message" << std::endl;
+}
+
+struct oscquery_device
+{
+    using map_type = coppa::locked_map<coppa::basic_map<coppa::oscquery::ParameterMap>>;
+    map_type& m_map;
+
+    map_type& map()
+    { return m_map; }
+
+    bool has_handler(const std::string&) const
+    { return false; }
+
+    void notify(const coppa::oscquery::Parameter&)
+    { }
+};
+
+int main()
+{
+  using namespace coppa;
+
+  {
+    using namespace coppa::ossia;
+    basic_map<ParameterMapType<Parameter>> base_map;
+    locked_map<basic_map<ParameterMapType<Parameter>>> map{base_map};
+    for(auto address : {"/benchmark/int/value", "/benchmark/float/value", "/benchmark/string/value"})
+    {
+      Parameter p;
+      p.destination = address;
+      map.insert(p);
+    }
+    map.update("/benchmark/int/value", [] (Parameter& p) { p.value = int32_t{}; });
+    map.update("/benchmark/float/value", [] (Parameter& p) { p.value = float{}; });
+    map.update("/benchmark/string/value", [] (Parameter& p) { p.value = std::string(64, ' '); });
+
+    device_with_callbacks dev;
+    auto handle = [&] (const oscpack::ReceivedMessage& m) {
+      osc_message_handler::on_messageReceived(dev, map, m, oscpack::IpEndpointName{});
+    };
+
+    bench("ossia int", make_message("/benchmark/int/value", int32_t(12)), handle);
+    bench("ossia float", make_message("/benchmark/float/value", 3.5f), handle);
+    bench("ossia string", make_message("/benchmark/string/value", "a received string, longer than SSO"), handle);
+
+    // A labelled position : the elements of the tuple are overwritten.
+    map.insert([] {
+      Parameter p;
+      p.destination = "/benchmark/tuple/value";
+      p.value = Tuple{};
+      return p;
+    }());
+    {
+      char buffer[1024];
+      oscpack::OutboundPacketStream p{buffer, sizeof(buffer)};
+      p << oscpack::BeginMessage("/benchmark/tuple/value")
+        << 0.5f << 0.25f << "a label, longer than SSO"
+        << oscpack::EndMessage();
+      bench("ossia tuple", std::string(p.Data(), p.Size()), handle);
+    }
+
+    // A blob, e.g. a thumbnail, read by a value callback or a view callback.
+    for(auto address : {"/benchmark/blob/value", "/benchmark/blob/view"})
+    {
+      Parameter p;
+      p.destination = address;
+      p.value = coppa::Generic{std::string(600, ' ')};
+      map.insert(p);
+    }
+    const std::string thumbnail(600, 'x');
+    const oscpack::Blob blob(thumbnail.data(), thumbnail.size());
+
+    std::size_t received = 0;
+    auto value_callback = [&] (coppa::ossia::Value v) {
+      received += eggs::variants::get<coppa::Generic>(v.value).buf.size();
+    };
+    dev.get_value_callback("/benchmark/blob/value").connect(&value_callback);
+    bench("ossia blob, value callback", make_message("/benchmark/blob/value", blob), handle);
+
+    auto view_callback = [&] (const value_view& v) {
+      received += eggs::variants::get<blob_view>(v.front()).size;
+    };
+    dev.get_view_callback("/benchmark/blob/view").connect(&view_callback);
+    bench("ossia blob, view callback", make_message("/benchmark/blob/view", blob), handle);
+  }
+
+  {
+    using namespace coppa::oscquery;
+    basic_map<ParameterMap> base_map;
+    oscquery_device::map_type map{base_map};
+    for(auto address : {"/benchmark/int/value", "/benchmark/float/value"})
+    {
+      Parameter p;
+      p.destination = address;
+      map.insert(p);
+    }
+    map.update("/benchmark/int/value", [] (Parameter& p) { p.values.push_back(int{}); });
+    map.update("/benchmark/float/value", [] (Parameter& p) { p.values.push_back(float{}); });
+
+    oscquery_device dev{map};
+    auto handle = [&] (const oscpack::ReceivedMessage& m) {
+      coppa::osc::message_handler::on_messageReceived(dev, m);
+    };
+
+    bench("oscquery int", make_message("/benchmark/int/value", int32_t(12)), handle);
+    bench("oscquery float", make_message("/benchmark/float/value", 3.5f), handle);
+  }
+}
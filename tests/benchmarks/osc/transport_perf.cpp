@@ -0,0 +1,61 @@
+#include <coppa/protocol/osc/oscreceiver.hpp>
+#include <coppa/protocol/osc/oscsender.hpp>
+#include <coppa/protocol/osc/oscunixreceiver.hpp>
+#include <coppa/protocol/osc/oscunixsender.hpp>
+#include <coppa/protocol/osc/oscshmreceiver.hpp>
+#include <coppa/protocol/osc/oscshmsender.hpp>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+
+// Sends messages to a receiver of the same process and measures
+// how many are received per second.
+static const constexpr int message_count = 200000;
+
+template<typename Receiver, typename Sender>
+void bench(const char* name, unsigned int port)
+{
+  using clock = std::chrono::steady_clock;
+  std::atomic<int> count{0};
+  std::atomic<clock::rep> last_received{0};
+  Receiver r{port, [&] (const auto&, const auto&) {
+      count++;
+      last_received = clock::now().time_since_epoch().count();
+    }};
+  r.run();
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  Sender s{"127.0.0.1", int(r.port())};
+
+  auto start = clock::now();
+  for(int i = 0; i < message_count; i++)
+    s.send(std::string("/benchmark/value"), int32_t(i), 1.f);
+
+  // Waits for the last messages, if they are not lost.
+  int last = -1;
+  while(count < message_count && count != last)
+  {
+    last = count;
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  }
+  auto end = clock::time_point{clock::duration{last_received.load()}};
+
+  if(count == 0)
+  {
+    std::cout << name << ": nothing received" << std::endl;
+    return;
+  }
+
+  auto ms = std::chrono::duration<double, std::milli>(end - start).count();
+  std::cout << name << ": "
+            << count << " / " << message_count << " received in " << ms << " ms ("
+            << int(count / (ms / 1000.)) << " messages/s)" << std::endl;
+}
+
+int main()
+{
+  using namespace coppa::osc;
+  bench<receiver, sender>("UDP", 9870);
+  bench<unix_receiver, unix_sender>("Unix socket", 9880);
+  bench<shm_receiver, shm_sender>("Shared memory", 9890);
+}
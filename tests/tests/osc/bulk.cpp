@@ -0,0 +1,126 @@
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+#include <coppa/protocol/osc/oscbulk.hpp>
+#include <coppa/ossia/device/osc_common.hpp>
+#include <coppa/minuit/device/osc_common.hpp>
+#include <oscpack/osc/OscOutboundPacketStream.h>
+#include <oscpack/osc/OscReceivedElements.h>
+#include <vector>
+using namespace coppa;
+
+static std::vector<char> buffer(1 << 16);
+
+template<typename Fun>
+static oscpack::ReceivedMessage make_message(Fun write)
+{
+  oscpack::OutboundPacketStream s{buffer.data(), buffer.size()};
+  s << oscpack::BeginMessage("/a");
+  write(s);
+  s << oscpack::EndMessage();
+  return oscpack::ReceivedMessage{oscpack::ReceivedPacket{s.Data(), static_cast<int>(s.Size())}};
+}
+
+TEST_CASE( "big endian words", "[osc][bulk]" ) {
+  std::vector<char> data(4 * 40 + 1);
+  for(std::size_t i = 0; i < data.size(); i++)
+    data[i] = char(i * 7 + 3);
+
+  // Unaligned source, and all the sizes around the vector widths.
+  for(std::size_t count = 0; count <= 40; count++)
+  {
+    std::vector<uint32_t> out(count);
+    osc::read_big_endian_32(data.data() + 1, count, out.data());
+    for(std::size_t i = 0; i < count; i++)
+    {
+      auto u = reinterpret_cast<const unsigned char*>(data.data() + 1 + 4 * i);
+      REQUIRE(out[i] == (uint32_t(u[0]) << 24 | uint32_t(u[1]) << 16 | uint32_t(u[2]) << 8 | u[3]));
+    }
+  }
+}
+
+TEST_CASE( "argument positions", "[osc][bulk]" ) {
+  const char blob[5]{1, 2, 3, 4, 5};
+  auto m = make_message([&] (auto& s) {
+    s << "some string" << oscpack::Blob(blob, 5) << int32_t(7) << 2.5f << 3.5f;
+  });
+
+  auto it = m.ArgumentsBegin();
+  for(int i = 0; i < 3; i++)
+    ++it;
+
+  auto pos = osc::locate(m, it);
+  REQUIRE(*pos.tag == 'f');
+  REQUIRE(osc::numeric_run(pos.tag) == 2);
+
+  uint32_t word;
+  osc::read_big_endian_32(pos.data, 1, &word);
+  float f;
+  std::memcpy(&f, &word, 4);
+  REQUIRE(f == 2.5f);
+}
+
+TEST_CASE( "ossia tuples are decoded in bulk", "[osc][bulk]" ) {
+  auto m = make_message([] (auto& s) {
+    s << "text";
+    for(int i = 0; i < 300; i++)
+      s << float(i) / 2.f;
+    s << int32_t(-1) << true;
+    for(int i = 0; i < 20; i++)
+      s << int32_t(i - 10);
+  });
+
+  ossia::Tuple bulk, expected;
+  ossia::convert_tuple(m, bulk);
+  ossia::convert_tuple(m.ArgumentsBegin(), m.ArgumentsEnd(), expected);
+
+  REQUIRE(bulk.variants.size() == 323);
+  REQUIRE(bulk == expected);
+  REQUIRE(eggs::variants::get<float>(bulk.variants[300]) == 149.5f);
+  REQUIRE(eggs::variants::get<int32_t>(bulk.variants[322]) == 9);
+}
+
+TEST_CASE( "minuit arrays are decoded in bulk", "[osc][bulk]" ) {
+  auto m = make_message([] (auto& s) {
+    s << int32_t(1) << oscpack::ArrayInitiator{};
+    for(int i = 0; i < 100; i++)
+      s << float(i);
+    s << oscpack::ArrayInitiator{} << 1.f << 2.f << oscpack::ArrayTerminator{};
+    for(int i = 0; i < 10; i++)
+      s << int32_t(i);
+    s << oscpack::ArrayTerminator{} << int32_t(2);
+  });
+
+  minuit::Tuple inner{0.f, 0.f};
+  minuit::Tuple tuple;
+  for(int i = 0; i < 100; i++)
+    tuple.variants.push_back(0.f);
+  tuple.variants.push_back(inner);
+  for(int i = 0; i < 10; i++)
+    tuple.variants.push_back(int32_t{});
+
+  using namespace coppa::minuit;
+  Values values{int32_t{}, tuple, int32_t{}};
+  REQUIRE(match_type_tags(values, m));
+
+  Values bulk = values;
+  values_reader<strict_error_handler, conversion_mode::Prechecked>{}(
+        m.ArgumentsBegin(), m.ArgumentsEnd(), bulk, &m);
+
+  Values expected = values;
+  values_reader<strict_error_handler, conversion_mode::Prechecked>{}(
+        m.ArgumentsBegin(), m.ArgumentsEnd(), expected);
+
+  REQUIRE(bulk.variants == expected.variants);
+  const auto& res = eggs::variants::get<Tuple>(bulk.variants[1]);
+  REQUIRE(eggs::variants::get<float>(res.variants[99]) == 99.f);
+  REQUIRE(eggs::variants::get<Tuple>(res.variants[100]) == (Tuple{1.f, 2.f}));
+  REQUIRE(eggs::variants::get<int32_t>(res.variants[110]) == 9);
+  REQUIRE(eggs::variants::get<int32_t>(bulk.variants[2]) == 2);
+
+  // Converted : the tuple is read again from the message.
+  Values converted = values;
+  values_reader<lax_error_handler, conversion_mode::Convert>{}(
+        m.ArgumentsBegin(), m.ArgumentsEnd(), converted, &m);
+  REQUIRE(eggs::variants::get<float>(eggs::variants::get<Tuple>(converted.variants[1]).variants[50]) == 50.f);
+  REQUIRE(eggs::variants::get<int32_t>(converted.variants[2]) == 2);
+}
@@ -0,0 +1,231 @@
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+#include <coppa/protocol/osc/osccoalescingsender.hpp>
+#include <oscpack/osc/OscReceivedElements.h>
+#include <mutex>
+using namespace coppa;
+using namespace coppa::osc;
+
+// Records the packets instead of sending them
+struct mock_sender
+{
+    mock_sender(const std::string& ip, int port):
+      m_ip{ip},
+      m_port{port}
+    {
+    }
+
+    void send_raw(const char* data, std::size_t size)
+    {
+      std::lock_guard<std::mutex> l{packets_mutex()};
+      packets().emplace_back(data, size);
+    }
+
+    const std::string& ip() const { return m_ip; }
+    int port() const { return m_port; }
+
+    static std::vector<std::string>& packets()
+    {
+      static std::vector<std::string> p;
+      return p;
+    }
+    static std::mutex& packets_mutex()
+    {
+      static std::mutex m;
+      return m;
+    }
+
+    std::string m_ip;
+    int m_port{};
+};
+
+static int32_t received_int(const oscpack::ReceivedMessage& m)
+{
+  return m.ArgumentsBegin()->AsInt32();
+}
+
+TEST_CASE( "latest value wins", "[osc][coalescing]" ) {
+  mock_sender::packets().clear();
+  {
+    coalescing_sender<mock_sender> s("127.0.0.1", 1234, std::chrono::hours(1));
+    for(int i = 0; i < 1000; i++)
+      s.send(std::string("/slider"), int32_t(i));
+
+    s.flush();
+
+    REQUIRE(mock_sender::packets().size() == 1);
+    const auto& packet = mock_sender::packets()[0];
+    oscpack::ReceivedPacket p(packet.data(), packet.size());
+    REQUIRE(p.IsMessage());
+    oscpack::ReceivedMessage m(p);
+    REQUIRE(string_view(m.AddressPattern()) == "/slider");
+    REQUIRE(received_int(m) == 999);
+
+    // Nothing is pending anymore
+    s.flush();
+    REQUIRE(mock_sender::packets().size() == 1);
+  }
+}
+
+TEST_CASE( "every change in a bundle", "[osc][coalescing]" ) {
+  mock_sender::packets().clear();
+  {
+    coalescing_sender<mock_sender> s(
+          "127.0.0.1", 1234,
+          std::chrono::hours(1),
+          coalescing_mode::Bundle);
+    s.send(std::string("/a"), int32_t(1));
+    s.send(std::string("/b"), int32_t(10));
+    s.send(std::string("/a"), int32_t(2));
+
+    s.flush();
+
+    REQUIRE(mock_sender::packets().size() == 1);
+    const auto& packet = mock_sender::packets()[0];
+    oscpack::ReceivedPacket p(packet.data(), packet.size());
+    REQUIRE(p.IsBundle());
+
+    oscpack::ReceivedBundle b(p);
+    REQUIRE(b.TimeTag() == immediate_time_tag);
+
+    std::vector<std::pair<std::string, int32_t>> res;
+    for(auto it = b.ElementsBegin(); it != b.ElementsEnd(); ++it)
+    {
+      oscpack::ReceivedMessage m(*it);
+      res.emplace_back(m.AddressPattern(), received_int(m));
+    }
+
+    // The order of the calls to send is kept, across addresses
+    std::vector<std::pair<std::string, int32_t>> expected{{"/a", 1}, {"/b", 10}, {"/a", 2}};
+    REQUIRE(res == expected);
+  }
+}
+
+TEST_CASE( "switching to the latest value", "[osc][coalescing]" ) {
+  mock_sender::packets().clear();
+  {
+    coalescing_sender<mock_sender> s(
+          "127.0.0.1", 1234,
+          std::chrono::hours(1),
+          coalescing_mode::Bundle);
+    s.send(std::string("/a"), int32_t(1));
+    s.send(std::string("/a"), int32_t(2));
+    s.send(std::string("/a"), int32_t(3));
+
+    // Only the last pending message is kept, and replaced afterwards.
+    s.set_mode(coalescing_mode::Latest);
+    s.flush();
+    REQUIRE(mock_sender::packets().size() == 1);
+    {
+      oscpack::ReceivedMessage m(oscpack::ReceivedPacket(mock_sender::packets()[0].data(), mock_sender::packets()[0].size()));
+      REQUIRE(received_int(m) == 3);
+    }
+
+    s.send(std::string("/a"), int32_t(4));
+    s.send(std::string("/a"), int32_t(5));
+    s.flush();
+    REQUIRE(mock_sender::packets().size() == 2);
+    oscpack::ReceivedMessage m(oscpack::ReceivedPacket(mock_sender::packets()[1].data(), mock_sender::packets()[1].size()));
+    REQUIRE(received_int(m) == 5);
+  }
+}
+
+TEST_CASE( "pending values are flushed on destruction", "[osc][coalescing]" ) {
+  mock_sender::packets().clear();
+  {
+    coalescing_sender<mock_sender> s("127.0.0.1", 1234, std::chrono::hours(1));
+    s.send(std::string("/a"), int32_t(1));
+  }
+  REQUIRE(mock_sender::packets().size() == 1);
+}
+
+TEST_CASE( "bundles are split", "[osc][coalescing]" ) {
+  mock_sender::packets().clear();
+  {
+    coalescing_sender<mock_sender> s("127.0.0.1", 1234, std::chrono::hours(1));
+    s.set_max_packet_size(64);
+    s.send(std::string("/a"), int32_t(1));
+    s.send(std::string("/b"), int32_t(1));
+    s.send(std::string("/c"), int32_t(1));
+    s.send(std::string("/d"), int32_t(1));
+    s.flush();
+
+    REQUIRE(mock_sender::packets().size() > 1);
+    for(const auto& packet : mock_sender::packets())
+      REQUIRE(packet.size() <= 64);
+  }
+}
+
+TEST_CASE( "per-subtree rate", "[osc][coalescing]" ) {
+  mock_sender::packets().clear();
+  {
+    using clock = coalescing_sender<mock_sender>::clock;
+    coalescing_sender<mock_sender> s("127.0.0.1", 1234, std::chrono::hours(1));
+    s.set_rate("/fast", std::chrono::milliseconds(10));
+
+    // The first flush schedules the next ones
+    s.send(std::string("/fast/x"), int32_t(1));
+    s.send(std::string("/slow"), int32_t(1));
+    s.flush();
+    const auto start = clock::now();
+    {
+      std::lock_guard<std::mutex> l{mock_sender::packets_mutex()};
+      mock_sender::packets().clear();
+    }
+
+    s.send(std::string("/fast/x"), int32_t(2));
+    s.send(std::string("/slow"), int32_t(2));
+
+    // The sender's thread may also have sent the fast address in the meantime.
+    auto check_sent = [] (const char* address) {
+      std::lock_guard<std::mutex> l{mock_sender::packets_mutex()};
+      REQUIRE(mock_sender::packets().size() == 1);
+      const auto& packet = mock_sender::packets()[0];
+      oscpack::ReceivedMessage m(oscpack::ReceivedPacket(packet.data(), packet.size()));
+      REQUIRE(string_view(m.AddressPattern()) == address);
+      REQUIRE(received_int(m) == 2);
+      mock_sender::packets().clear();
+    };
+
+    s.tick(start + std::chrono::seconds(1));
+    check_sent("/fast/x");
+
+    s.tick(start + std::chrono::hours(2));
+    check_sent("/slow");
+  }
+}
+
+TEST_CASE( "higher priorities are sent first", "[osc][coalescing]" ) {
+  mock_sender::packets().clear();
+  {
+    coalescing_sender<mock_sender> s("127.0.0.1", 1234, std::chrono::hours(1));
+    s.set_max_packet_size(64);
+    s.set_priority("/transport", 10);
+    s.set_priority("/meters", -1);
+    s.send(std::string("/meters/1"), int32_t(1));
+    s.send(std::string("/meters/2"), int32_t(1));
+    s.send(std::string("/mixer/gain"), int32_t(1));
+    s.send(std::string("/transport/play"), int32_t(1));
+    s.flush();
+
+    std::vector<std::string> addresses;
+    for(const auto& packet : mock_sender::packets())
+    {
+      oscpack::ReceivedPacket p(packet.data(), packet.size());
+      if(p.IsBundle())
+      {
+        oscpack::ReceivedBundle b(p);
+        for(auto it = b.ElementsBegin(); it != b.ElementsEnd(); ++it)
+          addresses.push_back(oscpack::ReceivedMessage(*it).AddressPattern());
+      }
+      else
+      {
+        addresses.push_back(oscpack::ReceivedMessage(p).AddressPattern());
+      }
+    }
+
+    // Same priority : the order of the addresses is kept.
+    std::vector<std::string> expected{"/transport/play", "/mixer/gain", "/meters/1", "/meters/2"};
+    REQUIRE(addresses == expected);
+  }
+}
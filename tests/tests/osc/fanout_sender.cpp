@@ -0,0 +1,118 @@
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+#include <coppa/protocol/osc/oscfanoutsender.hpp>
+#include <oscpack/osc/OscReceivedElements.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+using namespace coppa;
+using namespace coppa::osc;
+
+// A bound UDP socket on the loopback, with a random port.
+struct loopback_socket
+{
+    loopback_socket()
+    {
+      fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+      sockaddr_in addr{};
+      addr.sin_family = AF_INET;
+      addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+      ::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+
+      socklen_t len = sizeof(addr);
+      ::getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len);
+      port = ntohs(addr.sin_port);
+
+      timeval tv{1, 0};
+      ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    }
+
+    ~loopback_socket()
+    {
+      ::close(fd);
+    }
+
+    // Returns the address of the received message, or an empty string.
+    std::string receive()
+    {
+      char buf[1024];
+      auto n = ::recv(fd, buf, sizeof(buf), 0);
+      if(n <= 0)
+        return {};
+
+      oscpack::ReceivedMessage m(oscpack::ReceivedPacket(buf, n));
+      return m.AddressPattern();
+    }
+
+    int fd{};
+    int port{};
+};
+
+TEST_CASE( "endpoints", "[osc][fanout]" ) {
+  fanout_sender s(2);
+  REQUIRE(s.add_endpoint("127.0.0.1", 1234));
+  REQUIRE(s.add_endpoint("127.0.0.1", 1234));
+  REQUIRE(s.endpoint_count() == 1);
+
+  REQUIRE(!s.add_endpoint("not an ip", 1234));
+  REQUIRE(!s.add_endpoint("127.0.0.1", 0));
+
+  // Host names are resolved.
+  REQUIRE(s.add_endpoint("localhost", 1234));
+  REQUIRE(s.endpoint_count() == 1);
+
+  REQUIRE(s.add_endpoint("127.0.0.1", 1235));
+  REQUIRE(!s.add_endpoint("127.0.0.1", 1236)); // Full
+  REQUIRE(s.endpoint_count() == 2);
+
+  REQUIRE(s.remove_endpoint("127.0.0.1", 1234));
+  REQUIRE(!s.remove_endpoint("127.0.0.1", 1234));
+  REQUIRE(s.add_endpoint("127.0.0.1", 1236)); // Reuses the free slot
+  REQUIRE(s.endpoint_count() == 2);
+
+  s.clear_endpoints();
+  REQUIRE(s.endpoint_count() == 0);
+}
+
+TEST_CASE( "concurrent additions", "[osc][fanout]" ) {
+  fanout_sender s(16);
+  for(int round = 0; round < 100; round++)
+  {
+    std::atomic<bool> start{false};
+    std::vector<std::thread> threads;
+    for(int i = 0; i < 4; i++)
+    {
+      threads.emplace_back([&] {
+        while(!start) { }
+        s.add_endpoint("127.0.0.1", 1234);
+      });
+    }
+    start = true;
+    for(auto& t : threads)
+      t.join();
+
+    REQUIRE(s.endpoint_count() == 1);
+    s.clear_endpoints();
+  }
+}
+
+TEST_CASE( "send to every endpoint", "[osc][fanout]" ) {
+  loopback_socket a, b, c;
+
+  fanout_sender s;
+  s.add_endpoint("127.0.0.1", a.port);
+  s.add_endpoint("127.0.0.1", b.port);
+  s.add_endpoint("127.0.0.1", c.port);
+  s.remove_endpoint("127.0.0.1", b.port);
+
+  s.send(std::string("/foo"), int32_t(1));
+
+  REQUIRE(a.receive() == "/foo");
+  REQUIRE(c.receive() == "/foo");
+
+  s.add_endpoint("127.0.0.1", b.port);
+  s.send(std::string("/bar"), 1.5f);
+  REQUIRE(a.receive() == "/bar");
+  REQUIRE(b.receive() == "/bar");
+  REQUIRE(c.receive() == "/bar");
+}
@@ -0,0 +1,174 @@
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+#include <coppa/protocol/osc/oscscheduler.hpp>
+#include <coppa/ossia/device/osc_message_handler.hpp>
+#include <coppa/ossia/device/device_with_callbacks.hpp>
+#include <coppa/map.hpp>
+#include <oscpack/osc/OscReceivedElements.h>
+#include <atomic>
+using namespace coppa;
+using namespace coppa::osc;
+
+// A bundle with a single message : /value i
+static std::string make_bundle(uint64_t time_tag, int32_t value)
+{
+  char buffer[1024];
+  oscpack::OutboundPacketStream p{buffer, sizeof(buffer)};
+  p << oscpack::BeginBundle(time_tag)
+    << oscpack::BeginMessage("/value") << value << oscpack::EndMessage()
+    << oscpack::EndBundle();
+  return std::string(p.Data(), p.Size());
+}
+
+struct recorder
+{
+    std::mutex mutex;
+    std::vector<int32_t> values;
+
+    void operator()(const char* data, std::size_t size)
+    {
+      oscpack::ReceivedBundle b{oscpack::ReceivedPacket{data, static_cast<int>(size)}};
+      oscpack::ReceivedMessage m{*b.ElementsBegin()};
+
+      std::lock_guard<std::mutex> l{mutex};
+      values.push_back(m.ArgumentsBegin()->AsInt32());
+    }
+
+    std::vector<int32_t> get()
+    {
+      std::lock_guard<std::mutex> l{mutex};
+      return values;
+    }
+};
+
+TEST_CASE( "time tags", "[osc][scheduler]" ) {
+  auto now = std::chrono::system_clock::now();
+  auto diff = to_time_point(to_time_tag(now)) - now;
+  REQUIRE(std::abs(std::chrono::duration_cast<std::chrono::microseconds>(diff).count()) <= 1);
+}
+
+TEST_CASE( "bundles are applied at their time", "[osc][scheduler]" ) {
+  recorder r;
+  bundle_scheduler s{[&] (const char* data, std::size_t size) { r(data, size); }};
+
+  auto now = std::chrono::system_clock::now();
+  auto b3 = make_bundle(to_time_tag(now + std::chrono::milliseconds(150)), 3);
+  auto b2 = make_bundle(to_time_tag(now + std::chrono::milliseconds(100)), 2);
+  auto b2bis = make_bundle(to_time_tag(now + std::chrono::milliseconds(100)), 22);
+  auto b1 = make_bundle(immediate_time_tag, 1);
+
+  s.schedule(b3.data(), b3.size());
+  s.schedule(b2.data(), b2.size());
+  s.schedule(b2bis.data(), b2bis.size());
+  s.schedule(b1.data(), b1.size());
+
+  // The immediate one is applied right away
+  REQUIRE(r.get() == std::vector<int32_t>{1});
+  REQUIRE(s.pending() == 3);
+
+  for(int i = 0; i < 100 && s.pending() > 0; i++)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+  REQUIRE(std::chrono::system_clock::now() >= now + std::chrono::milliseconds(150));
+  REQUIRE((r.get() == std::vector<int32_t>{1, 2, 22, 3}));
+}
+
+TEST_CASE( "late bundles", "[osc][scheduler]" ) {
+  recorder r;
+  bundle_scheduler s{[&] (const char* data, std::size_t size) { r(data, size); }};
+
+  auto late = make_bundle(to_time_tag(std::chrono::system_clock::now() - std::chrono::seconds(1)), 1);
+  s.schedule(late.data(), late.size());
+  REQUIRE(r.get() == std::vector<int32_t>{1});
+
+  s.set_late_policy(late_bundle_policy::Drop);
+  s.schedule(late.data(), late.size());
+  REQUIRE(r.get() == std::vector<int32_t>{1});
+  REQUIRE(s.pending() == 0);
+}
+
+TEST_CASE( "bundles are applied in a single transaction", "[osc][scheduler]" ) {
+  using namespace coppa::ossia;
+  basic_map<ParameterMapType<Parameter>> base_map;
+  locked_map<basic_map<ParameterMapType<Parameter>>> map{base_map};
+  for(auto address : {"/a", "/b"})
+  {
+    Parameter p;
+    p.destination = address;
+    p.value = int32_t{0};
+    map.insert(p);
+  }
+
+  char buffer[1024];
+  oscpack::OutboundPacketStream p{buffer, sizeof(buffer)};
+  p << oscpack::BeginBundle(immediate_time_tag)
+    << oscpack::BeginMessage("/a") << int32_t(1) << oscpack::EndMessage()
+    << oscpack::BeginMessage("/unknown") << int32_t(1) << oscpack::EndMessage()
+    << oscpack::BeginMessage("/b") << int32_t(2) << oscpack::EndMessage()
+    << oscpack::EndBundle();
+
+  device_with_callbacks dev;
+  osc_message_handler::on_bundleReceived(
+        dev, map,
+        oscpack::ReceivedBundle{oscpack::ReceivedPacket{p.Data(), static_cast<int>(p.Size())}});
+
+  REQUIRE(eggs::variants::get<int32_t>(map.get("/a").value) == 1);
+  REQUIRE(eggs::variants::get<int32_t>(map.get("/b").value) == 2);
+}
+
+TEST_CASE( "nested bundles are applied at their time", "[osc][scheduler]" ) {
+  using namespace coppa::ossia;
+  using map_t = locked_map<basic_map<ParameterMapType<Parameter>>>;
+  basic_map<ParameterMapType<Parameter>> base_map;
+  map_t map{base_map};
+  for(auto address : {"/a", "/b"})
+  {
+    Parameter p;
+    p.destination = address;
+    p.value = int32_t{0};
+    map.insert(p);
+  }
+
+  struct scheduled_device : public device_with_callbacks
+  {
+      scheduled_device(map_t& map):
+        scheduler{[&] (const char* data, std::size_t size) {
+          osc_message_handler::on_bundleReceived(
+                *this, map,
+                oscpack::ReceivedBundle{oscpack::ReceivedPacket{data, static_cast<int>(size)}});
+        }}
+      {
+      }
+
+      bundle_scheduler scheduler;
+  };
+
+  char buffer[1024];
+  oscpack::OutboundPacketStream p{buffer, sizeof(buffer)};
+  p << oscpack::BeginBundle(immediate_time_tag)
+    << oscpack::BeginMessage("/a") << int32_t(1) << oscpack::EndMessage()
+    << oscpack::BeginBundle(to_time_tag(std::chrono::system_clock::now() + std::chrono::milliseconds(100)))
+    << oscpack::BeginMessage("/b") << int32_t(2) << oscpack::EndMessage()
+    << oscpack::EndBundle()
+    << oscpack::EndBundle();
+  oscpack::ReceivedBundle bundle{oscpack::ReceivedPacket{p.Data(), static_cast<int>(p.Size())}};
+
+  // Without a scheduler, the nested bundle is applied with the enclosing one.
+  device_with_callbacks dev;
+  osc_message_handler::on_bundleReceived(dev, map, bundle);
+  REQUIRE(eggs::variants::get<int32_t>(map.get("/a").value) == 1);
+  REQUIRE(eggs::variants::get<int32_t>(map.get("/b").value) == 2);
+
+  map.update("/a", [] (Parameter& p) { p.value = int32_t{0}; });
+  map.update("/b", [] (Parameter& p) { p.value = int32_t{0}; });
+
+  scheduled_device scheduled{map};
+  osc_message_handler::on_bundleReceived(scheduled, map, bundle);
+  REQUIRE(eggs::variants::get<int32_t>(map.get("/a").value) == 1);
+  REQUIRE(eggs::variants::get<int32_t>(map.get("/b").value) == 0);
+  REQUIRE(scheduled.scheduler.pending() == 1);
+
+  for(int i = 0; i < 100 && eggs::variants::get<int32_t>(map.get("/b").value) == 0; i++)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  REQUIRE(eggs::variants::get<int32_t>(map.get("/b").value) == 2);
+}
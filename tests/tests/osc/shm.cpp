@@ -0,0 +1,109 @@
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+#include <coppa/protocol/osc/oscshmsender.hpp>
+#include <coppa/protocol/osc/oscshmreceiver.hpp>
+#include <atomic>
+#include <sys/wait.h>
+using namespace coppa;
+using namespace coppa::osc;
+
+TEST_CASE( "ring", "[osc][shm]" ) {
+  shm_ring reader;
+  REQUIRE(reader.create("/coppa.test.ring", 4, 16));
+
+  shm_ring writer;
+  REQUIRE(writer.open("/coppa.test.ring"));
+
+  // Other readers cannot create it again
+  shm_ring other;
+  REQUIRE(!other.create("/coppa.test.ring"));
+
+  REQUIRE(!writer.push("01234567890123456", 17)); // Too big
+  for(int i = 0; i < 4; i++)
+    REQUIRE(writer.push("abcd", 4));
+  REQUIRE(!writer.push("abcd", 4)); // Full
+
+  std::string res;
+  auto append = [&] (const char* data, std::size_t size) { res.append(data, size); };
+  for(int i = 0; i < 4; i++)
+    REQUIRE(reader.pop(append));
+  REQUIRE(!reader.pop(append));
+  REQUIRE(res == "abcdabcdabcdabcd");
+
+  REQUIRE(writer.valid());
+  reader.close();
+  REQUIRE(!writer.valid());
+}
+
+TEST_CASE( "transport", "[osc][shm]" ) {
+  std::atomic<int> count{0};
+  std::atomic<bool> ordered{true};
+  shm_receiver r{9870, [&] (const oscpack::ReceivedMessage& m, const oscpack::IpEndpointName&) {
+      if(m.ArgumentsBegin()->AsInt32() != count)
+        ordered = false;
+      count++;
+    }};
+  r.run();
+
+  shm_sender s{"127.0.0.1", int(r.port())};
+  for(int i = 0; i < 100000; i++)
+  {
+    oscpack::MessageGenerator<> gen;
+    const auto& p = gen(std::string("/foo"), int32_t(i));
+    while(!s.send_raw(p.Data(), p.Size()))
+      std::this_thread::yield();
+  }
+
+  for(int i = 0; i < 500 && count < 100000; i++)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+  REQUIRE(count == 100000);
+  REQUIRE(ordered);
+
+  // The sender follows the receiver when it is restarted.
+  r.setPort(r.port());
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  s.send(std::string("/foo"), int32_t(100000));
+  for(int i = 0; i < 100 && count == 100000; i++)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  REQUIRE(count == 100001);
+}
+
+TEST_CASE( "receiver crash", "[osc][shm]" ) {
+  const auto name = shm_ring::segment_name(9871);
+
+  // A receiver that exits without closing its segment.
+  const pid_t pid = ::fork();
+  if(pid == 0)
+  {
+    shm_ring crashed;
+    crashed.create(name, 4, 64);
+    ::_exit(0);
+  }
+  REQUIRE(pid > 0);
+  ::waitpid(pid, nullptr, 0);
+
+  shm_sender s{"127.0.0.1", 9871};
+
+  // The restarted receiver replaces the segment.
+  shm_ring restarted;
+  REQUIRE(restarted.create(name, 4, 64));
+
+  // The sender fills the orphaned segment, then finds the new one.
+  oscpack::MessageGenerator<> gen;
+  const auto& p = gen(std::string("/foo"), int32_t(1));
+  bool sent = false;
+  for(int i = 0; i < 100 && !sent; i++)
+  {
+    for(int j = 0; j < 8 && !sent; j++)
+      s.send_raw(p.Data(), p.Size());
+    sent = !restarted.empty();
+    if(!sent)
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  REQUIRE(sent);
+
+  std::string res;
+  REQUIRE(restarted.pop([&] (const char* data, std::size_t size) { res.assign(data, size); }));
+  REQUIRE(res == std::string(p.Data(), p.Size()));
+}
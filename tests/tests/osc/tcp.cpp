@@ -0,0 +1,138 @@
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+#include <coppa/protocol/osc/osctcpsender.hpp>
+#include <coppa/protocol/osc/osctcpreceiver.hpp>
+#include <atomic>
+using namespace coppa;
+using namespace coppa::osc;
+
+static std::vector<std::string> test_packets()
+{
+  return {
+    std::string("abcd"),
+    std::string("\xC0\xC0\xDB\xDB\xDC\xDD", 6),
+    std::string(1000, '\xC0'),
+    std::string(100000, 'x')
+  };
+}
+
+static void check_framing(stream_framing framing, std::size_t chunk_size)
+{
+  std::string stream;
+  for(const auto& packet : test_packets())
+    write_frame(stream, packet.data(), packet.size(), framing);
+
+  std::vector<std::string> res;
+  stream_decoder decoder{framing};
+  for(std::size_t i = 0; i < stream.size(); i += chunk_size)
+  {
+    auto n = std::min(chunk_size, stream.size() - i);
+    REQUIRE(decoder.feed(stream.data() + i, n, [&] (const char* data, std::size_t size) {
+      res.emplace_back(data, size);
+    }));
+  }
+
+  REQUIRE(res == test_packets());
+}
+
+TEST_CASE( "framing", "[osc][tcp]" ) {
+  for(auto framing : {stream_framing::Slip, stream_framing::LengthPrefix})
+  {
+    check_framing(framing, 1);
+    check_framing(framing, 3);
+    check_framing(framing, 4096);
+    check_framing(framing, 1000000);
+  }
+}
+
+TEST_CASE( "invalid streams", "[osc][tcp]" ) {
+  auto ignore = [] (const char*, std::size_t) { };
+  {
+    stream_decoder decoder{stream_framing::LengthPrefix, 16};
+    const char too_big[4] = {0, 0, 0, 17};
+    REQUIRE(!decoder.feed(too_big, 4, ignore));
+  }
+  {
+    stream_decoder decoder{stream_framing::Slip};
+    const char bad_escape[3] = {'\xC0', '\xDB', 'a'};
+    REQUIRE(!decoder.feed(bad_escape, 3, ignore));
+  }
+}
+
+static void check_transport(stream_framing framing)
+{
+  std::atomic<int> count{0};
+  std::atomic<int> big{0};
+  std::atomic<bool> ordered{true};
+  tcp_receiver r{9870, [&] (const oscpack::ReceivedMessage& m, const oscpack::IpEndpointName&) {
+      if(string_view(m.AddressPattern()) == "/big")
+      {
+        big = std::strlen(m.ArgumentsBegin()->AsString());
+        return;
+      }
+      if(m.ArgumentsBegin()->AsInt32() != count)
+        ordered = false;
+      count++;
+    }, framing};
+  r.run();
+
+  tcp_sender s{"127.0.0.1", int(r.port()), framing};
+  for(int i = 0; i < 10000; i++)
+    s.send(std::string("/foo"), int32_t(i));
+  s.send(std::string("/big"), std::string(200000, 'x'));
+
+  for(int i = 0; i < 500 && big == 0; i++)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+  REQUIRE(count == 10000);
+  REQUIRE(ordered);
+  REQUIRE(big == 200000);
+}
+
+TEST_CASE( "transport", "[osc][tcp]" ) {
+  check_transport(stream_framing::Slip);
+  check_transport(stream_framing::LengthPrefix);
+}
+
+TEST_CASE( "unsent frames", "[osc][tcp]" ) {
+  for(auto framing : {stream_framing::Slip, stream_framing::LengthPrefix})
+  {
+    std::string stream;
+    std::vector<std::size_t> starts;
+    for(const auto& packet : test_packets())
+    {
+      starts.push_back(stream.size());
+      write_frame(stream, packet.data(), packet.size(), framing);
+    }
+
+    REQUIRE(first_unsent_frame(stream, 0, framing) == 0);
+    REQUIRE(first_unsent_frame(stream, 1, framing) == 0);
+    REQUIRE(first_unsent_frame(stream, starts[1], framing) == starts[1]);
+    REQUIRE(first_unsent_frame(stream, starts[2] + 10, framing) == starts[2]);
+    REQUIRE(first_unsent_frame(stream, stream.size() - 1, framing) == starts[3]);
+    REQUIRE(first_unsent_frame(stream, stream.size(), framing) == stream.size());
+  }
+}
+
+TEST_CASE( "peer not reading", "[osc][tcp]" ) {
+  // The connection is accepted by the system, but nothing is read.
+  boost::asio::io_service service;
+  boost::asio::ip::tcp::acceptor acceptor{
+    service, {boost::asio::ip::address::from_string("127.0.0.1"), 0}};
+
+  auto start = std::chrono::steady_clock::now();
+  {
+    tcp_sender s{"127.0.0.1", int(acceptor.local_endpoint().port())};
+    for(int i = 0; i < 500 && !s.connected(); i++)
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    REQUIRE(s.connected());
+
+    start = std::chrono::steady_clock::now();
+    for(int i = 0; i < 64; i++)
+      s.send(std::string("/big"), std::string(256 * 1024, 'x'));
+  }
+
+  // The destruction does not wait for the peer forever.
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+  REQUIRE(elapsed < std::chrono::seconds(10));
+}
@@ -0,0 +1,43 @@
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+#include <coppa/protocol/osc/oscunixsender.hpp>
+#include <coppa/protocol/osc/oscunixreceiver.hpp>
+#include <atomic>
+using namespace coppa;
+using namespace coppa::osc;
+
+TEST_CASE( "transport", "[osc][unix]" ) {
+  std::atomic<int> count{0};
+  std::atomic<bool> ordered{true};
+  auto handler = [&] (const oscpack::ReceivedMessage& m, const oscpack::IpEndpointName&) {
+    if(m.ArgumentsBegin()->AsInt32() != count)
+      ordered = false;
+    count++;
+  };
+
+  unix_receiver r{9870, handler};
+  r.run();
+
+  // The port is in use
+  unix_receiver r2{r.port(), handler};
+  REQUIRE(r2.port() != r.port());
+
+  unix_sender s{"127.0.0.1", int(r.port())};
+  for(int i = 0; i < 100000; i++)
+    s.send(std::string("/foo"), int32_t(i));
+
+  for(int i = 0; i < 500 && count < 100000; i++)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+  // Nothing is lost
+  REQUIRE(count == 100000);
+  REQUIRE(ordered);
+
+  // The sender follows the receiver when it is restarted.
+  r.setPort(r.port());
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  s.send(std::string("/foo"), int32_t(100000));
+  for(int i = 0; i < 100 && count == 100000; i++)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  REQUIRE(count == 100001);
+}
@@ -226,3 +226,39 @@ TEST_CASE( "map element removing", "[oscquery][map]" ) {
     }
   }
 }
+
+TEST_CASE( "map address cache", "[oscquery][map]" ) {
+  basic_map<ParameterMap> map;
+  Parameter p = random_anonymous_parameter();
+  p.destination = "/da";
+  map.insert(p);
+
+  // Cached after the first lookup
+  auto it = map.find_cached("/da");
+  REQUIRE(it != map.end());
+  REQUIRE(map.find_cached("/da") == it);
+  REQUIRE(map.find_cached("/do") == map.end());
+
+  // Invalidated on removal
+  map.remove("/da");
+  REQUIRE(map.find_cached("/da") == map.end());
+
+  map.insert(p);
+  REQUIRE(map.find_cached("/da") == map.find("/da"));
+
+  // A node renamed onto an existing address is erased
+  {
+    auto other = p;
+    other.destination = "/do";
+    map.insert(other);
+    REQUIRE(map.find_cached("/do") != map.end());
+    REQUIRE(map.update("/do", [] (auto& param) { param.destination = "/da"; }) == map.end());
+    REQUIRE(map.find_cached("/do") == map.end());
+    REQUIRE(map.find_cached("/da") == map.find("/da"));
+  }
+
+  // Copies do not share the cache
+  auto copy = map;
+  REQUIRE(copy.find_cached("/da") == copy.find("/da"));
+  REQUIRE(copy.find_cached("/da") != map.find("/da"));
+}
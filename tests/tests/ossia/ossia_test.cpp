@@ -125,6 +125,46 @@ TEST_CASE( "message handler", "[ossia][message_handler]" ) {
   }
 }
 
+TEST_CASE( "type tags precheck", "[ossia][message_handler]" ) {
+  char buffer[1024];
+  auto check = [&] (const Values& values, auto&& write) {
+    oscpack::OutboundPacketStream s{buffer, sizeof(buffer)};
+    s << oscpack::BeginMessage("/a");
+    write(s);
+    s << oscpack::EndMessage();
+    oscpack::ReceivedMessage m{oscpack::ReceivedPacket{s.Data(), static_cast<int>(s.Size())}};
+    return match_type_tags(values, m);
+  };
+
+  REQUIRE(check(Values{int32_t{}, 1.f}, [] (auto& s) { s << int32_t(1) << 2.f; }));
+  REQUIRE(check(Values{false}, [] (auto& s) { s << true; }));
+  REQUIRE(check(Values{Tuple{1.f, 2.f}}, [] (auto& s) {
+    s << oscpack::ArrayInitiator{} << 1.f << 2.f << oscpack::ArrayTerminator{}; }));
+
+  REQUIRE_FALSE(check(Values{int32_t{}}, [] (auto& s) { s << 1.f; }));
+  REQUIRE_FALSE(check(Values{int32_t{}}, [] (auto& s) { s << int32_t(1) << int32_t(2); }));
+  REQUIRE_FALSE(check(Values{int32_t{}, int32_t{}}, [] (auto& s) { s << int32_t(1); }));
+  REQUIRE_FALSE(check(Values{Tuple{1.f, 2.f}}, [] (auto& s) {
+    s << oscpack::ArrayInitiator{} << 1.f << oscpack::ArrayTerminator{}; }));
+}
+
+TEST_CASE( "message handler conversion", "[ossia][message_handler]" ) {
+  // A message whose types differ from the local ones is converted.
+  char buffer[1024];
+  oscpack::OutboundPacketStream s{buffer, sizeof(buffer)};
+  s << oscpack::BeginMessage("/a") << 12.5f << oscpack::EndMessage();
+  oscpack::ReceivedMessage m{oscpack::ReceivedPacket{s.Data(), static_cast<int>(s.Size())}};
+
+  mock_device d;
+  d.map.p.variants.push_back(int32_t{0});
+  oscpack::IpEndpointName ip;
+  coppa::minuit::osc_message_handler::on_messageReceived(d, d.map, m, ip);
+
+  auto val = d.map.p.variants[0];
+  REQUIRE(which(val) == Type::int_t);
+  REQUIRE(get<int32_t>(val) == 12);
+}
+
 TEST_CASE( "device", "[ossia][osc_local_device]" ) {
   coppa::basic_map<ParameterMapType<coppa::minuit::Parameter>> base_map;
   osc_local_impl::map_type map(base_map);
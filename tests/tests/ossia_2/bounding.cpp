@@ -0,0 +1,123 @@
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+#include <coppa/ossia/bounding.hpp>
+#include <coppa/ossia/device/osc_message_handler.hpp>
+#include <coppa/ossia/device/device_with_callbacks.hpp>
+#include <coppa/map.hpp>
+#include <oscpack/osc/OscOutboundPacketStream.h>
+#include <cmath>
+using namespace coppa;
+using namespace coppa::ossia;
+using namespace eggs::variants;
+
+static coppa::ossia::Range make_range(Variant min, Variant max)
+{
+  coppa::ossia::Range r;
+  r.min = min;
+  r.max = max;
+  return r;
+}
+
+TEST_CASE( "scalar bounding", "[ossia][bounding]" ) {
+  const auto range = make_range(0.f, 10.f);
+  auto bound = [&] (Bounding::Mode mode, Variant v) {
+    REQUIRE(apply_bounding(mode, range, v));
+    return v;
+  };
+
+  REQUIRE(get<float>(bound(Bounding::Mode::Free, 12.f)) == 12.f);
+  REQUIRE(get<float>(bound(Bounding::Mode::Clip, 12.f)) == 10.f);
+  REQUIRE(get<float>(bound(Bounding::Mode::Clip, -2.f)) == 0.f);
+  REQUIRE(get<float>(bound(Bounding::Mode::Wrap, 12.f)) == Approx(2.f));
+  REQUIRE(get<float>(bound(Bounding::Mode::Wrap, -2.f)) == Approx(8.f));
+  REQUIRE(get<float>(bound(Bounding::Mode::Fold, 12.f)) == Approx(8.f));
+  REQUIRE(get<float>(bound(Bounding::Mode::Fold, -2.f)) == Approx(2.f));
+  REQUIRE(get<float>(bound(Bounding::Mode::Fold, 23.f)) == Approx(3.f));
+
+  // Integers wrap into [min, max]
+  const auto midi = make_range(int32_t(0), int32_t(127));
+  Variant i = int32_t(128);
+  apply_bounding(Bounding::Mode::Wrap, midi, i);
+  REQUIRE(get<int32_t>(i) == 0);
+  i = int32_t(-1);
+  apply_bounding(Bounding::Mode::Wrap, midi, i);
+  REQUIRE(get<int32_t>(i) == 127);
+  i = int32_t(130);
+  apply_bounding(Bounding::Mode::Fold, midi, i);
+  REQUIRE(get<int32_t>(i) == 124);
+  i = int32_t(200);
+  apply_bounding(Bounding::Mode::Clip, midi, i);
+  REQUIRE(get<int32_t>(i) == 127);
+
+  // A single bound only works with Clip.
+  const auto positive = make_range(0.f, None{});
+  Variant f = -3.f;
+  REQUIRE(apply_bounding(Bounding::Mode::Clip, positive, f));
+  REQUIRE(get<float>(f) == 0.f);
+  REQUIRE(!apply_bounding(Bounding::Mode::Wrap, positive, f));
+
+  // Not numeric
+  Variant s = std::string("text");
+  REQUIRE(apply_bounding(Bounding::Mode::Clip, range, s));
+  REQUIRE(get<std::string>(s) == "text");
+}
+
+TEST_CASE( "array bounding", "[ossia][bounding]" ) {
+  // All the sizes around the vector widths, against the scalar kernels.
+  for(auto mode : {Bounding::Mode::Clip, Bounding::Mode::Wrap, Bounding::Mode::Fold})
+  {
+    for(std::size_t n = 0; n <= 20; n++)
+    {
+      float_array arr(n);
+      for(std::size_t i = 0; i < n; i++)
+        arr[i] = -7.3f + 1.9f * i;
+
+      Variant v = arr;
+      apply_bounding(mode, make_range(-1.f, 3.f), v);
+      const auto& res = get<float_array>(v);
+      for(std::size_t i = 0; i < n; i++)
+      {
+        float expected{};
+        switch(mode)
+        {
+          case Bounding::Mode::Clip: expected = bounding::clip(arr[i], -1.f, 3.f); break;
+          case Bounding::Mode::Wrap: expected = bounding::wrap(arr[i], -1.f, 4.f, 0.25f); break;
+          case Bounding::Mode::Fold: expected = bounding::fold(arr[i], -1.f, 4.f, 0.25f); break;
+          default: break;
+        }
+        REQUIRE(res[i] == Approx(expected));
+        REQUIRE(res[i] >= -1.f);
+        REQUIRE(res[i] <= 3.f);
+      }
+    }
+  }
+
+  Variant color = vec3f{{-0.5f, 0.5f, 1.5f}};
+  apply_bounding(Bounding::Mode::Clip, make_range(0.f, 1.f), color);
+  REQUIRE(get<vec3f>(color) == (vec3f{{0.f, 0.5f, 1.f}}));
+
+  Variant t = Tuple{2.5f, int32_t(-4), std::string("a"), Tuple{7.f}};
+  apply_bounding(Bounding::Mode::Clip, make_range(0.f, 2.f), t);
+  REQUIRE(get<Tuple>(t) == (Tuple{2.f, int32_t(0), std::string("a"), Tuple{2.f}}));
+}
+
+TEST_CASE( "received values are bounded", "[ossia][bounding]" ) {
+  basic_map<ParameterMapType<Parameter>> base_map;
+  locked_map<basic_map<ParameterMapType<Parameter>>> map{base_map};
+  Parameter p;
+  p.destination = "/gain";
+  p.value = float{};
+  p.min = 0.f;
+  p.max = 1.f;
+  p.bounding = Bounding::Mode::Clip;
+  map.insert(p);
+
+  device_with_callbacks dev;
+  char buffer[1024];
+  oscpack::OutboundPacketStream s{buffer, sizeof(buffer)};
+  s << oscpack::BeginMessage("/gain") << 4.f << oscpack::EndMessage();
+  oscpack::ReceivedMessage m{oscpack::ReceivedPacket{s.Data(), static_cast<int>(s.Size())}};
+  osc_message_handler::on_messageReceived(dev, map, m, oscpack::IpEndpointName{});
+
+  REQUIRE(get<float>(map.get("/gain").value) == 1.f);
+}
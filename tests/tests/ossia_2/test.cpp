@@ -3,7 +3,12 @@
 #include <coppa/ossia/parameter.hpp>
 #include <coppa/ossia/device/message_handler.hpp>
 #include <coppa/ossia/device/osc_local_device.hpp>
+#include <coppa/ossia/device/minuit_listening_local_device.hpp>
+#include <coppa/ossia/device/minuit_remote_future.hpp>
 #include <coppa/tools/random.hpp>
+#include <atomic>
+#include <cmath>
+#include <thread>
 using namespace coppa;
 using namespace coppa::ossia;
 using namespace eggs::variants;
@@ -21,3 +26,1139 @@ TEST_CASE( "value init", "[ossia][value]" ) {
 
     REQUIRE(vals_out == vals_in);
 }
+
+TEST_CASE( "osc messages are decoded in place", "[ossia][osc]" ) {
+    basic_map<ParameterMapType<Parameter>> base_map;
+    locked_map<basic_map<ParameterMapType<Parameter>>> map{base_map};
+    Parameter p;
+    p.destination = "/int";
+    p.value = int32_t{0};
+    map.insert(p);
+    p.destination = "/string";
+    p.value = std::string{};
+    map.insert(p);
+    p.destination = "/tuple";
+    p.value = Tuple{};
+    map.insert(p);
+
+    device_with_callbacks dev;
+    std::vector<int32_t> received;
+    auto callback = [&] (coppa::ossia::Value v) {
+        received.push_back(get<int32_t>(v.value));
+    };
+    dev.get_value_callback("/int").connect(&callback);
+
+    char buffer[1024];
+    auto receive = [&] (auto&& write) {
+        oscpack::OutboundPacketStream s{buffer, sizeof(buffer)};
+        write(s);
+        oscpack::ReceivedMessage m{oscpack::ReceivedPacket{s.Data(), static_cast<int>(s.Size())}};
+        osc_message_handler::on_messageReceived(dev, map, m, oscpack::IpEndpointName{});
+    };
+
+    receive([] (auto& s) { s << oscpack::BeginMessage("/int") << int32_t(12) << oscpack::EndMessage(); });
+    REQUIRE(get<int32_t>(map.get("/int").value) == 12);
+    REQUIRE(received == std::vector<int32_t>{12});
+
+    // Converted to the type of the parameter
+    receive([] (auto& s) { s << oscpack::BeginMessage("/int") << 3.5f << oscpack::EndMessage(); });
+    REQUIRE(get<int32_t>(map.get("/int").value) == 3);
+
+    receive([] (auto& s) { s << oscpack::BeginMessage("/string") << "some text" << oscpack::EndMessage(); });
+    REQUIRE(get<std::string>(map.get("/string").value) == "some text");
+
+    receive([] (auto& s) { s << oscpack::BeginMessage("/tuple") << int32_t(1) << 2.f << oscpack::EndMessage(); });
+    Tuple expected;
+    expected.variants = {int32_t(1), 2.f};
+    REQUIRE(get<Tuple>(map.get("/tuple").value) == expected);
+
+    receive([] (auto& s) { s << oscpack::BeginMessage("/unknown") << int32_t(1) << oscpack::EndMessage(); });
+    REQUIRE(map.size() == 4);
+    REQUIRE(received == std::vector<int32_t>({12, 3}));
+}
+
+TEST_CASE( "homogeneous arrays", "[ossia][osc]" ) {
+    basic_map<ParameterMapType<Parameter>> base_map;
+    locked_map<basic_map<ParameterMapType<Parameter>>> map{base_map};
+    Parameter p;
+    p.destination = "/floats";
+    p.value = float_array{};
+    map.insert(p);
+    p.destination = "/ints";
+    p.value = int_array{};
+    map.insert(p);
+    p.destination = "/position";
+    p.value = vec3f{};
+    map.insert(p);
+
+    device_with_callbacks dev;
+    char buffer[4096];
+    auto message = [&] (const char* address, const coppa::ossia::Variant& v) {
+        oscpack::OutboundPacketStream s{buffer, sizeof(buffer)};
+        s << oscpack::BeginMessage(address) << v << oscpack::EndMessage();
+        oscpack::ReceivedMessage m{oscpack::ReceivedPacket{s.Data(), static_cast<int>(s.Size())}};
+        osc_message_handler::on_messageReceived(dev, map, m, oscpack::IpEndpointName{});
+    };
+
+    float_array floats(100);
+    for(int i = 0; i < 100; i++)
+      floats[i] = i / 4.f;
+    message("/floats", floats);
+    REQUIRE(get<float_array>(map.get("/floats").value) == floats);
+
+    // The storage is reused for a message of the same size.
+    const float* data{};
+    map.update("/floats", [&] (Parameter& p) { data = get<float_array>(p.value).data(); });
+    floats[50] = -1.f;
+    message("/floats", floats);
+    map.update("/floats", [&] (Parameter& p) {
+      REQUIRE(get<float_array>(p.value).data() == data);
+      REQUIRE(get<float_array>(p.value) == floats);
+    });
+
+    // Mixed type tags are converted one by one.
+    message("/ints", Tuple{int32_t(1), 2.5f, true});
+    REQUIRE(get<int_array>(map.get("/ints").value) == (int_array{1, 2, 1}));
+    message("/ints", int_array{4, 5});
+    REQUIRE(get<int_array>(map.get("/ints").value) == (int_array{4, 5}));
+
+    message("/position", vec3f{{1.f, 2.f, 3.f}});
+    REQUIRE(get<vec3f>(map.get("/position").value) == (vec3f{{1.f, 2.f, 3.f}}));
+    message("/position", Tuple{int32_t(4), 5.f});
+    REQUIRE(get<vec3f>(map.get("/position").value) == (vec3f{{4.f, 5.f, 3.f}}));
+}
+
+TEST_CASE( "view callbacks", "[ossia][osc]" ) {
+    basic_map<ParameterMapType<Parameter>> base_map;
+    locked_map<basic_map<ParameterMapType<Parameter>>> map{base_map};
+    Parameter p;
+    p.destination = "/text";
+    p.value = std::string{};
+    map.insert(p);
+    p.destination = "/thumbnail";
+    p.value = coppa::Generic{};
+    map.insert(p);
+
+    device_with_callbacks dev;
+    char buffer[1024];
+
+    // The strings and blobs point into the packet.
+    std::vector<std::string> texts;
+    auto text_callback = [&] (const value_view& v) {
+        auto str = get<coppa::string_view>(v.front());
+        REQUIRE(str.data() >= buffer);
+        REQUIRE(str.data() < buffer + sizeof(buffer));
+        texts.push_back(str.to_string());
+    };
+    dev.get_view_callback("/text").connect(&text_callback);
+
+    std::string thumbnail;
+    auto thumbnail_callback = [&] (const value_view& v) {
+        REQUIRE(v.address() == "/thumbnail");
+        REQUIRE(v.size() == 1);
+        auto blob = get<blob_view>(v.front());
+        REQUIRE(blob.data > buffer);
+        thumbnail = blob.str().to_string();
+    };
+    dev.get_view_callback("/thumbnail").connect(&thumbnail_callback);
+
+    {
+      oscpack::OutboundPacketStream s{buffer, sizeof(buffer)};
+      s << oscpack::BeginMessage("/text") << "some text" << oscpack::EndMessage();
+      oscpack::ReceivedMessage m{oscpack::ReceivedPacket{s.Data(), static_cast<int>(s.Size())}};
+      osc_message_handler::on_messageReceived(dev, map, m, oscpack::IpEndpointName{});
+    }
+    REQUIRE(texts == std::vector<std::string>{"some text"});
+    REQUIRE(get<std::string>(map.get("/text").value) == "some text");
+
+    {
+      const char blob[6]{1, 2, 3, 0, 5, 6};
+      oscpack::OutboundPacketStream s{buffer, sizeof(buffer)};
+      s << oscpack::BeginBundle(1)
+        << oscpack::BeginMessage("/text") << "first" << oscpack::EndMessage()
+        << oscpack::BeginMessage("/thumbnail") << oscpack::Blob(blob, 6) << oscpack::EndMessage()
+        << oscpack::EndBundle();
+      oscpack::ReceivedBundle b{oscpack::ReceivedPacket{s.Data(), static_cast<int>(s.Size())}};
+      osc_message_handler::on_bundleReceived(dev, map, b);
+
+      REQUIRE(thumbnail == std::string(blob, 6));
+      REQUIRE(get<coppa::Generic>(map.get("/thumbnail").value).buf == std::string(blob, 6));
+    }
+    REQUIRE(texts == std::vector<std::string>({"some text", "first"}));
+}
+
+TEST_CASE( "tuples are decoded in place", "[ossia][osc]" ) {
+    char buffer[1024];
+    auto message = [&] (auto&& write) {
+        oscpack::OutboundPacketStream s{buffer, sizeof(buffer)};
+        s << oscpack::BeginMessage("/tuple");
+        write(s);
+        s << oscpack::EndMessage();
+        return oscpack::ReceivedMessage{oscpack::ReceivedPacket{s.Data(), static_cast<int>(s.Size())}};
+    };
+
+    Tuple tuple;
+    auto m = message([] (auto& s) { s << 1.f << 2.f << "a string longer than the small buffer"; });
+    convert_tuple(m, tuple);
+    REQUIRE(tuple == (Tuple{1.f, 2.f, std::string("a string longer than the small buffer")}));
+
+    // Same layout : the elements are overwritten.
+    const auto elements = tuple.variants.data();
+    const auto chars = get<std::string>(tuple.variants[2]).data();
+    m = message([] (auto& s) { s << int32_t(3) << 4.f << "another string, shorter than before"; });
+    convert_tuple(m.ArgumentsBegin(), m.ArgumentsEnd(), tuple);
+    REQUIRE(tuple == (Tuple{int32_t(3), 4.f, std::string("another string, shorter than before")}));
+    REQUIRE(tuple.variants.data() == elements);
+    REQUIRE(get<std::string>(tuple.variants[2]).data() == chars);
+
+    // Fewer arguments
+    m = message([] (auto& s) { s << 5.f; });
+    convert_tuple(m, tuple);
+    REQUIRE(tuple == (Tuple{5.f}));
+    REQUIRE(tuple.variants.data() == elements);
+}
+
+TEST_CASE( "repetition filter", "[ossia][osc]" ) {
+    REQUIRE(same_value(1.5f, 1.5f));
+    REQUIRE(!same_value(1.5f, int32_t(1)));
+    REQUIRE(!same_value(0.f, -0.f));
+    REQUIRE(same_value(std::nanf(""), std::nanf("")));
+    REQUIRE(same_value(Tuple{1.f, std::string("a")}, Tuple{1.f, std::string("a")}));
+    REQUIRE(!same_value(Tuple{1.f, std::string("a")}, Tuple{1.f}));
+    REQUIRE(same_value(vec3f{{1.f, 2.f, 3.f}}, vec3f{{1.f, 2.f, 3.f}}));
+    REQUIRE(!same_value(float_array{1.f, 2.f}, float_array{1.f, 2.5f}));
+
+    basic_map<ParameterMapType<Parameter>> base_map;
+    locked_map<basic_map<ParameterMapType<Parameter>>> map{base_map};
+    Parameter p;
+    p.destination = "/filtered";
+    p.value = float{};
+    p.repetitionFilter = true;
+    map.insert(p);
+    p.destination = "/unfiltered";
+    p.repetitionFilter = false;
+    map.insert(p);
+
+    device_with_callbacks dev;
+    std::vector<float> filtered, unfiltered;
+    auto filtered_callback = [&] (coppa::ossia::Value v) { filtered.push_back(get<float>(v.value)); };
+    auto unfiltered_callback = [&] (coppa::ossia::Value v) { unfiltered.push_back(get<float>(v.value)); };
+    dev.get_value_callback("/filtered").connect(&filtered_callback);
+    dev.get_value_callback("/unfiltered").connect(&unfiltered_callback);
+
+    char buffer[1024];
+    for(float f : {1.f, 1.f, 2.f, 2.f, 2.f, 1.f})
+    {
+      oscpack::OutboundPacketStream s{buffer, sizeof(buffer)};
+      s << oscpack::BeginBundle(1)
+        << oscpack::BeginMessage("/unfiltered") << f << oscpack::EndMessage()
+        << oscpack::EndBundle();
+      osc_message_handler::on_bundleReceived(dev, map, oscpack::ReceivedBundle{oscpack::ReceivedPacket{s.Data(), static_cast<int>(s.Size())}});
+
+      s.Clear();
+      s << oscpack::BeginMessage("/filtered") << f << oscpack::EndMessage();
+      oscpack::ReceivedMessage m{oscpack::ReceivedPacket{s.Data(), static_cast<int>(s.Size())}};
+      osc_message_handler::on_messageReceived(dev, map, m, oscpack::IpEndpointName{});
+    }
+
+    // Also in bundles
+    {
+      oscpack::OutboundPacketStream s{buffer, sizeof(buffer)};
+      s << oscpack::BeginBundle(1)
+        << oscpack::BeginMessage("/filtered") << 1.f << oscpack::EndMessage()
+        << oscpack::BeginMessage("/filtered") << 3.f << oscpack::EndMessage()
+        << oscpack::EndBundle();
+      osc_message_handler::on_bundleReceived(dev, map, oscpack::ReceivedBundle{oscpack::ReceivedPacket{s.Data(), static_cast<int>(s.Size())}});
+    }
+
+    REQUIRE(filtered == std::vector<float>({1.f, 2.f, 1.f, 3.f}));
+    REQUIRE(unfiltered == std::vector<float>({1.f, 1.f, 2.f, 2.f, 2.f, 1.f}));
+    REQUIRE(get<float>(map.get("/filtered").value) == 3.f);
+}
+
+TEST_CASE( "minuit listening clients", "[ossia][minuit]" ) {
+    basic_map<ParameterMapType<Parameter>> base_map;
+    minuit_listening_local_device::map_type map{base_map};
+    Parameter p;
+    p.destination = "/volume";
+    p.value = 0.f;
+    map.insert(p);
+
+    minuit_listening_local_device dev{map, "dev", 9876, 13579};
+
+    char buffer[1024];
+    auto request = [&] (const char* address, const char* listened, const char* enablement, oscpack::IpEndpointName ip) {
+        oscpack::OutboundPacketStream s{buffer, sizeof(buffer)};
+        s << oscpack::BeginMessage(address) << listened << enablement << oscpack::EndMessage();
+        dev.handle(oscpack::ReceivedMessage{oscpack::ReceivedPacket{s.Data(), static_cast<int>(s.Size())}}, ip);
+    };
+    const oscpack::IpEndpointName console_1{0x0A000001, 5000};
+    const oscpack::IpEndpointName console_2{0x0A000002, 5000};
+    // Same host, another source port : same client, since the replies go to 13579.
+    const oscpack::IpEndpointName console_1_bis{0x0A000001, 5001};
+
+    request("dev?listen", "/volume:value", "enable", console_1);
+    request("dev?listen", "/volume:value", "enable", console_2);
+    request("dev?listen", "/volume:value", "enable", console_1_bis);
+    request("dev?listen", "/unknown:value", "enable", console_1);
+    REQUIRE(dev.client_count() == 2);
+    REQUIRE(dev.subscriber_count("/volume") == 2);
+    REQUIRE(dev.subscriber_count("/unknown") == 0);
+
+    dev.update<coppa::string_view>(coppa::string_view("/volume"), [] (Parameter& p) { p.value = 0.5f; });
+    REQUIRE(get<float>(map.get("/volume").value) == 0.5f);
+
+    request("dev?listen", "/volume:value", "disable", console_2);
+    REQUIRE(dev.subscriber_count("/volume") == 1);
+    REQUIRE(dev.client_count() == 2);
+
+    // Idle clients are forgotten with their subscriptions.
+    dev.set_client_timeout(std::chrono::seconds(30));
+    dev.expire_clients(minuit_listening_local_device::clock::now() + std::chrono::seconds(10));
+    REQUIRE(dev.client_count() == 2);
+    dev.expire_clients(minuit_listening_local_device::clock::now() + std::chrono::seconds(60));
+    REQUIRE(dev.client_count() == 0);
+    REQUIRE(dev.subscriber_count("/volume") == 0);
+}
+
+// Records the packets sent to the clients of a listening device
+struct client_recorder
+{
+    struct packet
+    {
+        std::string ip;
+        std::string data;
+    };
+
+    client_recorder(const std::string& ip, int):
+      m_ip{ip}
+    {
+    }
+
+    template<typename... Args>
+    void send(Args&&... args)
+    {
+      const auto& s = oscpack::MessageGenerator<>{}(std::forward<Args>(args)...);
+      send_raw(s.Data(), s.Size());
+    }
+
+    void send_raw(const char* data, std::size_t size)
+    { packets().push_back({m_ip, std::string(data, size)}); }
+
+    static std::vector<packet>& packets()
+    {
+      static std::vector<packet> p;
+      return p;
+    }
+
+    // The listen replies of the packets sent to a client,
+    // as "/address:value=value" ; one vector per packet.
+    static std::vector<std::vector<std::string>> replies(const std::string& ip)
+    {
+      std::vector<std::vector<std::string>> res;
+      auto reply = [] (const oscpack::ReceivedMessage& m) {
+        auto it = m.ArgumentsBegin();
+        std::string str = it->AsString();
+        ++it;
+        return str + "=" + std::to_string(it->AsFloat());
+      };
+
+      for(const auto& p : packets())
+      {
+        if(p.ip != ip)
+          continue;
+
+        oscpack::ReceivedPacket packet{p.data.data(), static_cast<int>(p.data.size())};
+        res.emplace_back();
+        if(packet.IsBundle())
+        {
+          oscpack::ReceivedBundle b{packet};
+          for(auto it = b.ElementsBegin(); it != b.ElementsEnd(); ++it)
+            res.back().push_back(reply(oscpack::ReceivedMessage{*it}));
+        }
+        else
+        {
+          res.back().push_back(reply(oscpack::ReceivedMessage{packet}));
+        }
+      }
+      return res;
+    }
+
+    std::string m_ip;
+};
+
+TEST_CASE( "minuit listening notifications", "[ossia][minuit]" ) {
+    basic_map<ParameterMapType<Parameter>> base_map;
+    using device_t = basic_minuit_listening_local_device<client_recorder>;
+    device_t::map_type map{base_map};
+    Parameter p;
+    p.destination = "/volume";
+    p.value = 0.f;
+    map.insert(p);
+    p.destination = "/pan";
+    map.insert(p);
+
+    client_recorder::packets().clear();
+    device_t dev{map, "dev", 9877, 13580};
+
+    char buffer[1024];
+    auto request = [&] (const char* listened, oscpack::IpEndpointName ip) {
+        oscpack::OutboundPacketStream s{buffer, sizeof(buffer)};
+        s << oscpack::BeginMessage("dev?listen") << listened << "enable" << oscpack::EndMessage();
+        dev.handle(oscpack::ReceivedMessage{oscpack::ReceivedPacket{s.Data(), static_cast<int>(s.Size())}}, ip);
+    };
+    const oscpack::IpEndpointName console_1{0x0A000001, 5000};
+    const oscpack::IpEndpointName console_2{0x0A000002, 5000};
+
+    request("/volume:value", console_1);
+    dev.set_listen_interval(std::chrono::hours(1));
+    request("/volume:value", console_2);
+    request("/pan:value", console_2);
+
+    auto set = [&] (const char* address, float f) {
+        dev.update<coppa::string_view>(coppa::string_view(address), [=] (Parameter& p) { p.value = f; });
+    };
+
+    using replies_t = std::vector<std::vector<std::string>>;
+    const auto volume = [] (const char* v) { return std::string("/volume:value=") + v; };
+    const auto pan = [] (const char* v) { return std::string("/pan:value=") + v; };
+
+    // The first value is sent ; the next ones are held back for console_2.
+    // A batch is sent in one bundle per client,
+    // and a single reply without a bundle.
+    dev.begin_batch();
+    set("/volume", 0.1f);
+    set("/pan", 0.2f);
+    REQUIRE(client_recorder::packets().empty());
+    dev.end_batch();
+    REQUIRE(dev.pending_notifications() == 0);
+    REQUIRE(client_recorder::replies("10.0.0.1") == (replies_t{{volume("0.100000")}}));
+    REQUIRE(client_recorder::replies("10.0.0.2") == (replies_t{{volume("0.100000"), pan("0.200000")}}));
+    REQUIRE(client_recorder::packets().size() == 2);
+    for(const auto& p : client_recorder::packets())
+    {
+        oscpack::ReceivedPacket packet{p.data.data(), static_cast<int>(p.data.size())};
+        REQUIRE(packet.IsBundle() == (p.ip == "10.0.0.2"));
+    }
+
+    set("/volume", 0.3f);
+    set("/volume", 0.4f);
+    set("/pan", 0.5f);
+    REQUIRE(dev.pending_notifications() == 2);
+    REQUIRE(client_recorder::replies("10.0.0.1").size() == 3);
+    REQUIRE(client_recorder::replies("10.0.0.2").size() == 1);
+
+    // The held back values are only sent by flush_notifications,
+    // once due, and together.
+    dev.flush_notifications(device_t::clock::now());
+    REQUIRE(dev.pending_notifications() == 2);
+    REQUIRE(client_recorder::replies("10.0.0.2").size() == 1);
+    dev.flush_notifications(device_t::clock::now() + std::chrono::hours(2));
+    REQUIRE(dev.pending_notifications() == 0);
+    REQUIRE(client_recorder::replies("10.0.0.2").back() == (std::vector<std::string>{pan("0.500000"), volume("0.400000")}));
+
+    // Without a cap, nothing is ever pending.
+    dev.set_listen_interval("/volume", {});
+    set("/volume", 0.6f);
+    REQUIRE(dev.pending_notifications() == 0);
+}
+
+TEST_CASE( "minuit listen replies by priority", "[ossia][minuit]" ) {
+    basic_map<ParameterMapType<Parameter>> base_map;
+    using device_t = basic_minuit_listening_local_device<client_recorder>;
+    device_t::map_type map{base_map};
+    for(auto param : {std::make_pair("/meter", 0), std::make_pair("/cue", 5), std::make_pair("/transport", 10)})
+    {
+        Parameter p;
+        p.destination = param.first;
+        p.value = 0.f;
+        p.priority = param.second;
+        map.insert(p);
+    }
+
+    client_recorder::packets().clear();
+    device_t dev{map, "dev", 9882, 13585};
+
+    char buffer[1024];
+    const oscpack::IpEndpointName console{0x0A000001, 5000};
+    for(auto listened : {"/meter:value", "/cue:value", "/transport:value"})
+    {
+        oscpack::OutboundPacketStream s{buffer, sizeof(buffer)};
+        s << oscpack::BeginMessage("dev?listen") << listened << "enable" << oscpack::EndMessage();
+        dev.handle(oscpack::ReceivedMessage{oscpack::ReceivedPacket{s.Data(), static_cast<int>(s.Size())}}, console);
+    }
+
+    auto set = [&] (const char* address, float f) {
+        dev.update<coppa::string_view>(coppa::string_view(address), [=] (Parameter& p) { p.value = f; });
+    };
+
+    // Sent by decreasing priority, in the order of the updates otherwise.
+    dev.begin_batch();
+    set("/meter", 0.1f);
+    set("/cue", 0.2f);
+    set("/meter", 0.3f);
+    set("/transport", 0.4f);
+    dev.end_batch();
+
+    using replies_t = std::vector<std::vector<std::string>>;
+    REQUIRE(client_recorder::replies("10.0.0.1") == (replies_t{{
+        "/transport:value=0.400000",
+        "/cue:value=0.200000",
+        "/meter:value=0.100000",
+        "/meter:value=0.300000"}}));
+}
+
+TEST_CASE( "minuit listening osc messages", "[ossia][minuit]" ) {
+    basic_map<ParameterMapType<Parameter>> base_map;
+    minuit_listening_local_device::map_type map{base_map};
+    Parameter p;
+    p.destination = "/volume";
+    p.value = 0.f;
+    p.min = 0.f;
+    p.max = 1.f;
+    p.bounding = Bounding::Mode::Clip;
+    p.repetitionFilter = true;
+    map.insert(p);
+
+    minuit_listening_local_device dev{map, "dev", 9881, 13584};
+    int changed = 0;
+    std::vector<float> received;
+    auto on_changed = [&] (Parameter) { changed++; };
+    auto callback = [&] (coppa::ossia::Value v) { received.push_back(get<float>(v.value)); };
+    dev.on_value_changed.connect(&on_changed);
+    dev.get_value_callback("/volume").connect(&callback);
+
+    char buffer[1024];
+    const oscpack::IpEndpointName console{0x0A000001, 5000};
+    auto receive = [&] (auto&& write) {
+        oscpack::OutboundPacketStream s{buffer, sizeof(buffer)};
+        write(s);
+        dev.handle(oscpack::ReceivedMessage{oscpack::ReceivedPacket{s.Data(), static_cast<int>(s.Size())}}, console);
+    };
+
+    receive([] (auto& s) { s << oscpack::BeginMessage("dev?listen") << "/volume:value" << "enable" << oscpack::EndMessage(); });
+    REQUIRE(dev.subscriber_count("/volume") == 1);
+    dev.set_listen_interval("/volume", std::chrono::hours(1));
+
+    // A plain OSC message goes through the same path as update() :
+    // bounded, notified, and sent to the listening clients.
+    receive([] (auto& s) { s << oscpack::BeginMessage("/volume") << 5.f << oscpack::EndMessage(); });
+    REQUIRE(get<float>(map.get("/volume").value) == 1.f);
+    REQUIRE(changed == 1);
+    REQUIRE(received == std::vector<float>{1.f});
+    REQUIRE(dev.pending_notifications() == 0);
+
+    // Repetitions are filtered.
+    receive([] (auto& s) { s << oscpack::BeginMessage("/volume") << 3.f << oscpack::EndMessage(); });
+    REQUIRE(changed == 1);
+
+    // Held back by the rate cap of the subscription.
+    receive([] (auto& s) { s << oscpack::BeginMessage("/volume") << 0.5f << oscpack::EndMessage(); });
+    REQUIRE(changed == 2);
+    REQUIRE(received == (std::vector<float>{1.f, 0.5f}));
+    REQUIRE(dev.pending_notifications() == 1);
+}
+
+TEST_CASE( "minuit pattern listening", "[ossia][minuit]" ) {
+    REQUIRE(match_segment("ch*", "ch12"));
+    REQUIRE(match_segment("*", ""));
+    REQUIRE(match_segment("c?1*", "ch12"));
+    REQUIRE(match_segment("*2", "ch12"));
+    REQUIRE(!match_segment("ch?", "ch12"));
+    REQUIRE(!match_segment("*3", "ch12"));
+
+    basic_map<ParameterMapType<Parameter>> base_map;
+    minuit_listening_local_device::map_type map{base_map};
+    for(auto addr : {"/mixer/ch1/gain", "/mixer/ch1/mute", "/mixer/ch2/gain", "/fx/gain"})
+    {
+        Parameter p;
+        p.destination = addr;
+        p.value = 0.f;
+        map.insert(p);
+    }
+
+    minuit_listening_local_device dev{map, "dev", 9878, 13581};
+
+    char buffer[1024];
+    auto request = [&] (const char* listened, const char* enablement, oscpack::IpEndpointName ip) {
+        oscpack::OutboundPacketStream s{buffer, sizeof(buffer)};
+        s << oscpack::BeginMessage("dev?listen") << listened << enablement << oscpack::EndMessage();
+        dev.handle(oscpack::ReceivedMessage{oscpack::ReceivedPacket{s.Data(), static_cast<int>(s.Size())}}, ip);
+    };
+    auto set = [&] (const char* address, float f) {
+        dev.update<coppa::string_view>(coppa::string_view(address), [=] (Parameter& p) { p.value = f; });
+    };
+    const oscpack::IpEndpointName console_1{0x0A000001, 5000};
+    const oscpack::IpEndpointName console_2{0x0A000002, 5000};
+
+    // A container : stored once for its subtree.
+    request("/mixer:value", "enable", console_1);
+    REQUIRE(dev.subscriber_count("/mixer") == 0);
+    REQUIRE(dev.pattern_subscriber_count("/mixer", true) == 1);
+
+    // A pattern, rate-limited for each parameter it matches.
+    dev.set_listen_interval(std::chrono::hours(1));
+    request("/mixer/*/gain:value", "enable", console_2);
+    REQUIRE(dev.pattern_subscriber_count("/mixer/*/gain", false) == 1);
+
+    set("/mixer/ch1/gain", 0.1f);
+    set("/mixer/ch2/gain", 0.1f);
+    REQUIRE(dev.pending_notifications() == 0);
+    set("/mixer/ch1/gain", 0.2f);
+    REQUIRE(dev.pending_notifications() == 1);
+    set("/mixer/ch1/mute", 1.f);
+    set("/fx/gain", 1.f);
+    REQUIRE(dev.pending_notifications() == 1);
+
+    // The parameters created afterwards are matched too.
+    {
+        Parameter p;
+        p.destination = "/mixer/ch3/gain";
+        p.value = 0.f;
+        map.insert(p);
+    }
+    set("/mixer/ch3/gain", 0.1f);
+    REQUIRE(dev.pending_notifications() == 1);
+    set("/mixer/ch3/gain", 0.2f);
+    REQUIRE(dev.pending_notifications() == 2);
+
+    // A client listening several times to a parameter gets each value once :
+    // the exact subscription sends it, the pattern one does not hold it back.
+    request("/mixer/ch2/gain:value", "enable", console_2);
+    set("/mixer/ch2/gain", 0.2f);
+    REQUIRE(dev.pending_notifications() == 2);
+
+    dev.flush_notifications(minuit_listening_local_device::clock::now() + std::chrono::hours(2));
+    REQUIRE(dev.pending_notifications() == 0);
+
+    request("/mixer/*/gain:value", "disable", console_2);
+    REQUIRE(dev.pattern_subscriber_count("/mixer/*/gain", false) == 0);
+    request("/mixer:value", "disable", console_1);
+    REQUIRE(dev.pattern_subscriber_count("/mixer", true) == 0);
+
+    request("/mixer/ch?/gain:value", "enable", console_1);
+    dev.set_client_timeout(std::chrono::seconds(30));
+    dev.expire_clients(minuit_listening_local_device::clock::now() + std::chrono::seconds(60));
+    REQUIRE(dev.pattern_subscriber_count("/mixer/ch?/gain", false) == 0);
+}
+
+TEST_CASE( "minuit namespace crawler", "[ossia][minuit]" ) {
+    std::vector<std::string> sent;
+    minuit_namespace_crawler crawler{[&] (minuit_crawl_request, coppa::string_view address) {
+        sent.emplace_back(address.data(), address.size());
+    }};
+    crawler.set_window(2);
+    crawler.set_timeout(std::chrono::hours(1));
+    crawler.set_max_retries(1);
+
+    std::atomic_int finished{0};
+    crawler.on_finished([&] (const minuit_crawl_progress&) { finished++; });
+
+    REQUIRE(crawler.start("/"));
+    REQUIRE_FALSE(crawler.start("/"));
+    REQUIRE(sent.size() == 1);
+
+    // At most two requests in flight ; the namespaces go first.
+    crawler.request(minuit_crawl_request::Namespace, "/a");
+    crawler.request(minuit_crawl_request::Get, "/a:value");
+    crawler.request(minuit_crawl_request::Namespace, "/b");
+    crawler.request(minuit_crawl_request::Namespace, "/b");
+    REQUIRE(sent.size() == 2);
+    REQUIRE(sent[1] == "/a");
+    REQUIRE(crawler.progress().queued == 2);
+
+    crawler.answered("/");
+    crawler.answered("/");
+    REQUIRE(sent.size() == 3);
+    REQUIRE(sent[2] == "/b");
+
+    // Timeouts : sent again, then given up ; the window shrinks.
+    const auto later = minuit_namespace_crawler::clock::now() + std::chrono::hours(2);
+    crawler.tick(later);
+    REQUIRE(sent.size() == 5);
+    REQUIRE(crawler.progress().retried == 2);
+    REQUIRE(crawler.progress().window == 1);
+
+    crawler.answered("/a");
+    crawler.tick(later + std::chrono::hours(2));
+    REQUIRE(crawler.progress().failed == 1);
+    REQUIRE(sent.back() == "/a:value");
+    REQUIRE(finished == 0);
+
+    crawler.answered("/a:value");
+    REQUIRE(finished == 1);
+    REQUIRE_FALSE(crawler.running());
+    REQUIRE(crawler.progress().answered == 3);
+
+    // Without answers, the thread retries then gives up.
+    crawler.set_timeout(std::chrono::milliseconds(5));
+    sent.clear();
+    REQUIRE(crawler.start("/"));
+    for(int i = 0; i < 200 && finished < 2; i++)
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    REQUIRE(finished == 2);
+    REQUIRE(sent.size() == 2);
+    REQUIRE(crawler.progress().failed == 1);
+}
+
+TEST_CASE( "minuit remote refresh", "[ossia][minuit]" ) {
+    basic_map<ParameterMapType<Parameter>> base_map;
+    minuit_remote_impl_future::map_type map{base_map};
+    minuit_remote_impl_future remote{"remote", map, 9878, "127.0.0.1", 9879};
+
+    std::size_t progress_calls = 0;
+    remote.on_crawl_progress([&] (const minuit_crawl_progress&) { progress_calls++; });
+
+    auto fut = remote.refresh();
+    auto receive = [&] (const oscpack::OutboundPacketStream& s) {
+        minuit_remote_impl_future::data_handler_t::on_messageReceived(
+                    remote, remote.map(),
+                    oscpack::ReceivedMessage{oscpack::ReceivedPacket{s.Data(), static_cast<int>(s.Size())}},
+                    oscpack::IpEndpointName{});
+    };
+
+    char buffer[1024];
+    {
+        oscpack::OutboundPacketStream s{buffer, sizeof(buffer)};
+        s << oscpack::BeginMessage("dev:namespace") << "/" << "Application"
+          << "nodes={" << "a" << "}" << "attributes={" << "}" << oscpack::EndMessage();
+        receive(s);
+    }
+    REQUIRE(remote.crawl_progress().in_flight == 1);
+    {
+        oscpack::OutboundPacketStream s{buffer, sizeof(buffer)};
+        s << oscpack::BeginMessage("dev:namespace") << "/a" << "Data"
+          << "attributes={" << "value" << "}" << oscpack::EndMessage();
+        receive(s);
+    }
+    REQUIRE(fut.wait_for(std::chrono::seconds(0)) != std::future_status::ready);
+    {
+        oscpack::OutboundPacketStream s{buffer, sizeof(buffer)};
+        s << oscpack::BeginMessage("dev:get") << "/a:value" << 2.f << oscpack::EndMessage();
+        receive(s);
+    }
+    REQUIRE(fut.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+    REQUIRE(remote.map().size() == 1);
+    REQUIRE(remote.crawl_progress().answered == 3);
+    REQUIRE(progress_calls >= 4);
+}
+
+TEST_CASE( "minuit remote pull", "[ossia][minuit]" ) {
+    basic_map<ParameterMapType<Parameter>> base_map;
+    minuit_remote_impl_future::map_type map{base_map};
+    Parameter p;
+    p.value = 0.f;
+    p.destination = "/a";
+    map.insert(p);
+    p.destination = "/b";
+    map.insert(p);
+    minuit_remote_impl_future remote{"remote", map, 9880, "127.0.0.1", 9881};
+
+    char buffer[1024];
+    auto reply = [&] (const char* address, float f) {
+        oscpack::OutboundPacketStream s{buffer, sizeof(buffer)};
+        s << oscpack::BeginMessage("dev:get") << address << f << oscpack::EndMessage();
+        minuit_remote_impl_future::data_handler_t::on_messageReceived(
+                    remote, remote.map(),
+                    oscpack::ReceivedMessage{oscpack::ReceivedPacket{s.Data(), static_cast<int>(s.Size())}},
+                    oscpack::IpEndpointName{});
+    };
+
+    // One reply fulfills all the pulls of an address.
+    auto f1 = remote.pull("/a");
+    auto f2 = remote.pull("/a");
+    auto many = remote.pull_many({"/a", "/b"});
+    REQUIRE(remote.m_gets.pending() == 4);
+
+    reply("/a:value", 1.f);
+    REQUIRE(get<float>(f1.get().value) == 1.f);
+    REQUIRE(get<float>(f2.get().value) == 1.f);
+    REQUIRE(many.wait_for(std::chrono::seconds(0)) != std::future_status::ready);
+
+    reply("/b:value", 2.f);
+    auto values = many.get();
+    REQUIRE(values.size() == 2);
+    REQUIRE(values[0].destination == "/a");
+    REQUIRE(get<float>(values[1].value) == 2.f);
+    REQUIRE(remote.m_gets.pending() == 0);
+
+    // Without reply, the pulls time out.
+    remote.set_pull_timeout(std::chrono::milliseconds(10));
+    auto lost = remote.pull("/a");
+    auto lost_many = remote.pull_many({"/a", "/b"});
+    REQUIRE_THROWS_AS(lost.get(), TimeoutException);
+    REQUIRE_THROWS_AS(lost_many.get(), TimeoutException);
+    REQUIRE(remote.m_gets.pending() == 0);
+}
+
+TEST_CASE( "minuit concurrent pulls", "[ossia][minuit]" ) {
+    minuit_get_table table;
+    const int addresses = 64;
+    const int threads = 4;
+    const int pulls = 500;
+
+    std::atomic_int done{0};
+    std::atomic_int fulfilled{0};
+    std::vector<std::thread> pullers;
+    for(int t = 0; t < threads; t++)
+    {
+        pullers.emplace_back([&, t] {
+            for(int i = 0; i < pulls; i++)
+            {
+                auto address = "/" + std::to_string((t * pulls + i) % addresses);
+                auto deadline = minuit_get_table::clock::now() + std::chrono::seconds(30);
+                if(i % 10 == 0)
+                {
+                    auto f = table.add_many({address, "/0"}, deadline).first;
+                    f.get();
+                }
+                else
+                {
+                    auto f = table.add(address, deadline).first;
+                    if(f.get().destination == address)
+                        fulfilled++;
+                }
+            }
+            done++;
+        });
+    }
+
+    // The replies come from another thread, as from the receiver.
+    std::thread replier{[&] {
+        Parameter p;
+        while(done < threads)
+        {
+            for(int i = 0; i < addresses; i++)
+            {
+                p.destination = "/" + std::to_string(i);
+                table.fulfill(p.destination, p);
+            }
+        }
+    }};
+
+    for(auto& t : pullers)
+        t.join();
+    replier.join();
+
+    REQUIRE(fulfilled == threads * pulls * 9 / 10);
+    REQUIRE(table.pending() == 0);
+}
+
+// Keeps the packets sent by a local behaviour.
+struct recording_sender
+{
+    std::vector<std::string> packets;
+
+    template<typename... Args>
+    void send(Args&&... args)
+    {
+      const auto& s = oscpack::MessageGenerator<>{}(std::forward<Args>(args)...);
+      send_raw(s.Data(), s.Size());
+    }
+
+    void send_raw(const char* data, std::size_t size)
+    { packets.emplace_back(data, size); }
+};
+
+struct recording_device
+{
+    minuit_name_table nameTable{"dev"};
+    recording_sender sender;
+};
+
+TEST_CASE( "minuit subtree dump", "[ossia][minuit]" ) {
+    basic_map<ParameterMapType<Parameter>> local_map;
+    {
+        Parameter p;
+        p.destination = "/synth/volume";
+        p.value = 0.5f;
+        p.min = 0.f;
+        p.max = 1.f;
+        p.bounding = Bounding::Mode::Clip;
+        p.access = Access::Mode::Both;
+        p.priority = 5;
+        local_map.insert(p);
+
+        p = Parameter{};
+        p.destination = "/synth/notes";
+        Tuple t;
+        t.variants = {60, 64, std::string("C")};
+        p.value = t;
+        p.repetitionFilter = true;
+        local_map.insert(p);
+
+        p = Parameter{};
+        p.destination = "/other";
+        p.value = Impulse{};
+        local_map.insert(p);
+
+        for(int i = 0; i < 100; i++)
+        {
+            p = Parameter{};
+            p.destination = "/many/" + std::to_string(i);
+            p.value = int32_t(i);
+            local_map.insert(p);
+        }
+    }
+
+    recording_device local;
+    auto request = [&] (const char* root) {
+        char buffer[256];
+        oscpack::OutboundPacketStream s{buffer, sizeof(buffer)};
+        s << oscpack::BeginMessage("dev?dump") << root << oscpack::EndMessage();
+        local.sender.packets.clear();
+        minuit_local_behaviour<minuit_command::Request, minuit_operation::Dump>{}(
+                    local, local_map,
+                    oscpack::ReceivedMessage{oscpack::ReceivedPacket{s.Data(), static_cast<int>(s.Size())}});
+    };
+
+    basic_map<ParameterMapType<Parameter>> base_map;
+    minuit_remote_impl_future::map_type map{base_map};
+    auto receive = [&] (minuit_remote_impl_future& remote, const std::string& packet) {
+        minuit_remote_impl_future::data_handler_t::on_messageReceived(
+                    remote, remote.map(),
+                    oscpack::ReceivedMessage{oscpack::ReceivedPacket{packet.data(), static_cast<int>(packet.size())}},
+                    oscpack::IpEndpointName{});
+    };
+
+    // Disabled on the local side : the remote falls back to namespace requests.
+    {
+        minuit_remote_impl_future remote{"remote", map, 9882, "127.0.0.1", 9883};
+        remote.nameTable.set_dump_extension(true);
+        auto fut = remote.refresh();
+        request("/");
+        REQUIRE(local.sender.packets.size() == 1);
+        receive(remote, local.sender.packets[0]);
+        REQUIRE(remote.crawl_progress().fallbacks == 1);
+        REQUIRE(remote.crawl_progress().in_flight == 1);
+        REQUIRE(fut.wait_for(std::chrono::seconds(0)) != std::future_status::ready);
+    }
+
+    local.nameTable.set_dump_extension(true);
+    request("/synth");
+    REQUIRE(local.sender.packets.size() == 1);
+    oscpack::ReceivedMessage synth{oscpack::ReceivedPacket{
+            local.sender.packets[0].data(), static_cast<int>(local.sender.packets[0].size())}};
+    REQUIRE(synth.ArgumentsBegin()->AsString() == std::string("/synth"));
+    REQUIRE((++synth.ArgumentsBegin())->AsInt32() == 2);
+
+    // The whole tree, in several messages.
+    minuit_remote_impl_future remote{"remote", map, 9884, "127.0.0.1", 9885};
+    remote.nameTable.set_dump_extension(true);
+    auto fut = remote.refresh();
+    request("/");
+    REQUIRE(local.sender.packets.size() > 1);
+    for(std::size_t i = 0; i < local.sender.packets.size(); i++)
+    {
+        REQUIRE(fut.wait_for(std::chrono::seconds(0)) != std::future_status::ready);
+        REQUIRE(local.sender.packets[i].size() < 1472);
+        receive(remote, local.sender.packets[i]);
+    }
+    REQUIRE(fut.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+    REQUIRE(remote.crawl_progress().dumped == local_map.size());
+    REQUIRE(remote.crawl_progress().sent == 1);
+
+    REQUIRE(base_map.size() == local_map.size());
+    REQUIRE(get<float>(base_map.get("/synth/volume").value) == 0.5f);
+    REQUIRE(get<float>(base_map.get("/synth/volume").max) == 1.f);
+    REQUIRE(base_map.get("/synth/volume").bounding == Bounding::Mode::Clip);
+    REQUIRE(base_map.get("/synth/volume").access == Access::Mode::Both);
+    REQUIRE(base_map.get("/synth/volume").priority == 5);
+    REQUIRE(get<Tuple>(base_map.get("/synth/notes").value).variants.size() == 3);
+    REQUIRE(get<std::string>(get<Tuple>(base_map.get("/synth/notes").value).variants[2]) == "C");
+    REQUIRE(base_map.get("/synth/notes").repetitionFilter);
+    REQUIRE(which(base_map.get("/other").value) == Type::impulse_t);
+    REQUIRE(get<int32_t>(base_map.get("/many/99").value) == 99);
+
+    // The priority is also answered to get requests.
+    local_map.update_attributes("/other", Priority{3});
+    {
+        char buffer[256];
+        oscpack::OutboundPacketStream s{buffer, sizeof(buffer)};
+        s << oscpack::BeginMessage("remote?get") << "/other:priority" << oscpack::EndMessage();
+        local.sender.packets.clear();
+        minuit_local_behaviour<minuit_command::Request, minuit_operation::Get>{}(
+                    local, local_map,
+                    oscpack::ReceivedMessage{oscpack::ReceivedPacket{s.Data(), static_cast<int>(s.Size())}});
+    }
+    REQUIRE(local.sender.packets.size() == 1);
+    receive(remote, local.sender.packets[0]);
+    REQUIRE(base_map.get("/other").priority == 3);
+
+    // A parameter that does not fit with the previous ones goes alone in a message.
+    auto address = [] (const std::string& packet) {
+        return std::string(oscpack::ReceivedMessage{oscpack::ReceivedPacket{
+                    packet.data(), static_cast<int>(packet.size())}}.AddressPattern());
+    };
+    {
+        Parameter p;
+        p.destination = "/big/a";
+        p.value = std::string(900, 'a');
+        local_map.insert(p);
+        p.destination = "/big/b";
+        p.value = std::string(65000, 'b');
+        local_map.insert(p);
+    }
+    request("/big");
+    REQUIRE(local.sender.packets.size() == 2);
+    for(const auto& packet : local.sender.packets)
+    {
+        REQUIRE(address(packet) == "dev:dump");
+        REQUIRE(packet.size() <= 65507);
+    }
+
+    // A parameter that does not fit in a datagram makes the dump fail.
+    {
+        Parameter p;
+        p.destination = "/big/c";
+        p.value = std::string(70000, 'c');
+        local_map.insert(p);
+    }
+    request("/big");
+    REQUIRE(!local.sender.packets.empty());
+    REQUIRE(address(local.sender.packets.back()) == "dev!dump");
+    for(const auto& packet : local.sender.packets)
+        REQUIRE(packet.size() <= 65507);
+}
+
+// Receives the plain OSC messages too.
+struct recording_osc_device : public recording_device
+{
+    const std::function<void(const Value&)>* find_value_callback(const std::string&)
+    { return nullptr; }
+    const std::function<void(const value_view&)>* find_view_callback(const std::string&)
+    { return nullptr; }
+};
+
+TEST_CASE( "minuit namespace reply cache", "[ossia][minuit]" ) {
+    basic_map<ParameterMapType<Parameter>> base_map;
+    locked_map<basic_map<ParameterMapType<Parameter>>> map{base_map};
+    for(auto addr : {"/synth/volume", "/synth/pan", "/other/gain"})
+    {
+        Parameter p;
+        p.destination = addr;
+        map.insert(p);
+    }
+
+    recording_osc_device local;
+    auto request = [&] (const char* address) {
+        char buffer[256];
+        oscpack::OutboundPacketStream s{buffer, sizeof(buffer)};
+        s << oscpack::BeginMessage("dev?namespace") << address << oscpack::EndMessage();
+        local.sender.packets.clear();
+        minuit_message_handler<minuit_local_behaviour>::on_messageReceived(
+                    local, map,
+                    oscpack::ReceivedMessage{oscpack::ReceivedPacket{s.Data(), static_cast<int>(s.Size())}},
+                    oscpack::IpEndpointName{});
+        REQUIRE(local.sender.packets.size() == 1);
+        return local.sender.packets[0];
+    };
+    auto& replies = base_map.namespace_replies();
+
+    const auto root = request("/");
+    const auto synth = request("/synth");
+    request("/other");
+    request("/synth/volume");
+    REQUIRE(replies.size() == 4);
+
+    // The unknown addresses are answered but not kept.
+    for(auto addr : {"/unknown/1", "/unknown/2", "/synth/volume/x"})
+        REQUIRE(!request(addr).empty());
+    REQUIRE(replies.size() == 4);
+
+    // Sent again as is.
+    REQUIRE(request("/synth") == synth);
+    REQUIRE(replies.find("/synth")->data() == replies.find("/synth")->data());
+    REQUIRE(replies.size() == 4);
+
+    // Only the container and its parents are invalidated.
+    {
+        Parameter p;
+        p.destination = "/synth/reverb";
+        map.insert(p);
+    }
+    REQUIRE(!replies.find("/synth"));
+    REQUIRE(!replies.find("/"));
+    REQUIRE(replies.find("/other"));
+    REQUIRE(replies.find("/synth/volume"));
+
+    const auto new_synth = request("/synth");
+    REQUIRE(new_synth != synth);
+    REQUIRE(new_synth.find("reverb") != std::string::npos);
+    REQUIRE(request("/") == root);
+
+    map.remove("/other");
+    REQUIRE(!replies.find("/other"));
+    REQUIRE(!replies.find("/"));
+    REQUIRE(replies.find("/synth"));
+
+    // Devices with another name do not use the replies.
+    recording_osc_device other;
+    other.nameTable = minuit_name_table{"other"};
+    char buffer[256];
+    oscpack::OutboundPacketStream s{buffer, sizeof(buffer)};
+    s << oscpack::BeginMessage("other?namespace") << "/synth" << oscpack::EndMessage();
+    minuit_message_handler<minuit_local_behaviour>::on_messageReceived(
+                other, map,
+                oscpack::ReceivedMessage{oscpack::ReceivedPacket{s.Data(), static_cast<int>(s.Size())}},
+                oscpack::IpEndpointName{});
+    REQUIRE(other.sender.packets.size() == 1);
+    REQUIRE(other.sender.packets[0].compare(0, 15, "other:namespace") == 0);
+}
+
+TEST_CASE( "minuit action parsing", "[ossia][minuit]" ) {
+    // The name is the one of the sender.
+    REQUIRE((find_action("dev?namespace") == minuit_action::NamespaceRequest));
+    REQUIRE((find_action("remote:get") == minuit_action::GetReply));
+    REQUIRE((find_action("a!listen") == minuit_action::ListenError));
+    REQUIRE((find_action("a?dump") == minuit_action::DumpRequest));
+    REQUIRE(!find_action("dev?gorilla"));
+    REQUIRE(!find_action("dev?getx"));
+    REQUIRE(!find_action("dev?"));
+    REQUIRE(!find_action("dev"));
+
+    REQUIRE((find_attribute("rangeClipmode") == minuit_attribute::RangeClipMode));
+    REQUIRE((find_attribute("repetitionsFilter") == minuit_attribute::RepetitionFilter));
+    REQUIRE((find_attribute("description") == minuit_attribute::Description));
+    REQUIRE(!find_attribute(""));
+    REQUIRE(!find_attribute("rangeBoundsX"));
+    REQUIRE(!find_attribute("val"));
+
+    coppa::string_view address;
+    minuit_attribute attr;
+    REQUIRE(split_attribute("/foo", address, attr));
+    REQUIRE(address == "/foo");
+    REQUIRE(attr == minuit_attribute::Value);
+    REQUIRE(split_attribute("/foo:service", address, attr));
+    REQUIRE(address == "/foo");
+    REQUIRE(attr == minuit_attribute::Service);
+    REQUIRE(!split_attribute("/foo:", address, attr));
+
+    // Malformed requests are dropped without an answer.
+    basic_map<ParameterMapType<Parameter>> base_map;
+    locked_map<basic_map<ParameterMapType<Parameter>>> map{base_map};
+    recording_osc_device local;
+    auto receive = [&] (const char* action, auto&&... args) {
+        char buffer[256];
+        oscpack::OutboundPacketStream s{buffer, sizeof(buffer)};
+        s << oscpack::BeginMessage(action);
+        [] (...) { } ((s << args, 0)...);
+        s << oscpack::EndMessage();
+        minuit_message_handler<minuit_local_behaviour>::on_messageReceived(
+                    local, map,
+                    oscpack::ReceivedMessage{oscpack::ReceivedPacket{s.Data(), static_cast<int>(s.Size())}},
+                    oscpack::IpEndpointName{});
+    };
+    receive("remote?namespace");
+    receive("remote?namespace", int32_t(1));
+    receive("remote?nothing", "/");
+    receive("remote?get", "/:");
+    REQUIRE(local.sender.packets.empty());
+
+    // The namespace replies are cached whatever the name of the sender.
+    receive("remote?namespace", "/");
+    receive("other?namespace", "/");
+    REQUIRE(local.sender.packets.size() == 2);
+    REQUIRE(local.sender.packets[0] == local.sender.packets[1]);
+    REQUIRE(base_map.namespace_replies().size() == 1);
+}